@@ -0,0 +1,451 @@
+#define _POSIX_C_SOURCE 199309L // clock_gettime()
+
+#include "libgravix2/api.h"
+#include "libgravix2/game.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Micro- and macro-benchmarks of the propagation of missiles. Each benchmark
+ * is repeated until it ran for at least the requested time and reports the
+ * mean time per operation. The results are written as a single JSON document
+ * together with the static configuration of the library, which also fixes the
+ * potential and the composition scheme, i.e., builds with different values of
+ * GRVX_POT_TYPE or GRVX_COMPOSITION_SCHEME are compared by running each of
+ * them.
+ *
+ * Usage: gravix2_bench [-t min_time] [-f filter] [-o output.json]
+ */
+
+struct Options {
+    double min_time;
+    const char *filter;
+    FILE *out;
+};
+
+struct Result {
+    char params[128];
+    unsigned long long ops;
+    double seconds;
+    const char *unit;
+};
+
+struct Bench {
+    const struct Options *opts;
+    bool first;
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static bool selected(const struct Bench *bench, const char *name)
+{
+    return bench->opts->filter == NULL || strstr(name, bench->opts->filter);
+}
+
+static void report(struct Bench *bench, const char *name, struct Result *r)
+{
+    fprintf(bench->opts->out,
+            "%s\n    {\"name\": \"%s\", \"params\": {%s}, \"unit\": \"%s\", "
+            "\"ops\": %llu, \"seconds\": %.6f, \"ns_per_op\": %.3f}",
+            bench->first ? "" : ",",
+            name,
+            r->params,
+            r->unit,
+            r->ops,
+            r->seconds,
+            1e9 * r->seconds / (double)r->ops);
+    fflush(bench->opts->out);
+    bench->first = false;
+}
+
+static GrvxPlanetsHandle new_universe(unsigned n_planets)
+{
+    GrvxPlanetsHandle planets = grvx_new_planets(n_planets);
+    struct GrvxRng rng = grvx_init_rng(n_planets);
+    const double min_dist = 1. / sqrt((double)n_planets);
+    grvx_rng_init_planets(planets, &rng, min_dist < .1 ? min_dist : .1);
+    return planets;
+}
+
+/*
+ * Missiles are streamed in chunks of STREAM_STEPS integration steps per sample
+ * s.t. the overhead per call is amortized.
+ */
+#define STREAM_STEPS 10
+
+struct StreamCounter {
+    unsigned long long n_steps;
+    struct GrvxMissileState prev; /* start of the last chunk */
+    struct GrvxMissileState last;
+};
+
+static int32_t count_steps(void *ctx,
+                           uint32_t i,
+                           const struct GrvxMissileState *state)
+{
+    (void)i;
+    struct StreamCounter *counter = ctx;
+    counter->n_steps += STREAM_STEPS;
+    counter->prev = counter->last;
+    counter->last = *state;
+    return 0;
+}
+
+static int32_t ignore_sample(void *ctx,
+                             uint32_t i,
+                             const struct GrvxMissileState *state)
+{
+    (void)ctx;
+    (void)i;
+    (void)state;
+    return 0;
+}
+
+/*
+ * Number of integration steps of a chunk of STREAM_STEPS steps that was
+ * stopped prematurely. The integration loop stops after the step that came
+ * too close to a planet and flags this only if the step was not the last one
+ * of the chunk, i.e., replaying the chunk with k steps is premature iff it
+ * stopped after less than k steps.
+ */
+static unsigned replay_chunk(const struct GrvxMissileState *start,
+                             GrvxPlanetsHandle planets,
+                             double h)
+{
+    unsigned k = 2;
+    for (; k < STREAM_STEPS; k++) {
+        struct GrvxMissileState state = *start;
+        int32_t premature = 0;
+        grvx_stream_missile(
+            &state, planets, h, k, 1, ignore_sample, NULL, &premature);
+        if (premature) {
+            break;
+        }
+    }
+
+    return k - 1;
+}
+
+/*
+ * Streams missiles until they hit a planet, after which they are relaunched
+ * from the next planet. Relaunching and counting the steps of the last chunk
+ * of a missile are not timed.
+ */
+static struct Result stream_steps(GrvxPlanetsHandle planets, double min_time)
+{
+    const unsigned n_planets = grvx_count_planets(planets);
+    const double v = .8 * grvx_v_esc();
+    const double h = 1e-3;
+
+    struct StreamCounter counter = {.n_steps = 0};
+    unsigned launch = 0;
+    grvx_launch_missile_state(&counter.last, planets, 0, v, 0.);
+
+    // builds the force engine (e.g., bakes the field) outside of the timing
+    struct GrvxMissileState state = counter.last;
+    int32_t premature = 0;
+    grvx_stream_missile(
+        &state, planets, h, 1, 1, ignore_sample, NULL, &premature);
+
+    struct Result r = {.ops = 0, .seconds = 0.};
+    state = counter.last;
+    do {
+        const double t0 = now();
+        grvx_stream_missile(&state,
+                            planets,
+                            h,
+                            STREAM_STEPS,
+                            1000,
+                            count_steps,
+                            &counter,
+                            &premature);
+        r.seconds += now() - t0;
+
+        if (premature) {
+            counter.n_steps -= STREAM_STEPS;
+            counter.n_steps += replay_chunk(&counter.prev, planets, h);
+
+            launch += 1;
+            grvx_launch_missile_state(
+                &counter.last, planets, launch % n_planets, v, .7 * launch);
+            state = counter.last;
+        }
+    } while (r.seconds < min_time);
+
+    r.ops = counter.n_steps;
+    return r;
+}
+
+static void bench_integration_step(struct Bench *bench,
+                                   const struct GrvxConfig *cfg)
+{
+    const char *name = "integration_step";
+    if (!selected(bench, name)) {
+        return;
+    }
+
+    GrvxPlanetsHandle planets = new_universe(1);
+    struct Result r = stream_steps(planets, bench->opts->min_time);
+    snprintf(r.params,
+             sizeof(r.params),
+             "\"scheme\": \"%s\", \"n_planets\": 1",
+             cfg->composition_scheme);
+    r.unit = "step";
+    report(bench, name, &r);
+
+    grvx_delete_planets(planets);
+}
+
+static void bench_gradV(struct Bench *bench,
+                        const struct GrvxConfig *cfg,
+                        const char *engine,
+                        unsigned n_planets)
+{
+    const char *name = "gradV";
+    if (!selected(bench, name)) {
+        return;
+    }
+
+    GrvxPlanetsHandle planets = new_universe(n_planets);
+    if (strcmp(engine, "tree") == 0) {
+        grvx_set_opening_angle(planets, .5);
+    } else if (strcmp(engine, "field") == 0) {
+        grvx_bake_field(planets, 64, .1);
+    }
+
+    // each (drift-kick-drift) step evaluates the force once per stage
+    struct Result r = stream_steps(planets, bench->opts->min_time);
+    r.ops *= (unsigned long long)cfg->n_stages;
+    snprintf(r.params,
+             sizeof(r.params),
+             "\"pot\": \"%s\", \"engine\": \"%s\", \"n_planets\": %u",
+             cfg->pot_type,
+             engine,
+             n_planets);
+    r.unit = "force_evaluation";
+    report(bench, name, &r);
+
+    grvx_delete_planets(planets);
+}
+
+static void bench_propagate_missile(struct Bench *bench, unsigned n_planets)
+{
+    const char *name = "propagate_missile";
+    if (!selected(bench, name)) {
+        return;
+    }
+
+    GrvxPlanetsHandle planets = new_universe(n_planets);
+    GrvxTrajectoryBatch batch = grvx_new_missiles(1);
+    struct GrvxTrajectory *trj = grvx_get_trajectory(batch, 0);
+    const double v = .8 * grvx_v_esc();
+
+    struct Result r = {.ops = 0, .seconds = 0.};
+    unsigned long long n_steps = 0;
+    const double t0 = now();
+    do {
+        const unsigned id = (unsigned)(r.ops % n_planets);
+        grvx_launch_missile(trj, planets, id, v, .7 * (double)r.ops);
+
+        int32_t premature = 0;
+        n_steps += grvx_propagate_missile(trj, planets, 1e-3, &premature);
+        r.ops += 1;
+        r.seconds = now() - t0;
+    } while (r.seconds < bench->opts->min_time);
+
+    snprintf(r.params,
+             sizeof(r.params),
+             "\"n_planets\": %u, \"mean_trajectory_size\": %.1f",
+             n_planets,
+             (double)n_steps / (double)r.ops);
+    r.unit = "missile";
+    report(bench, name, &r);
+
+    grvx_delete_missiles(batch);
+    grvx_delete_planets(planets);
+}
+
+static struct GrvxMissileLaunch
+game_launch(unsigned tick, unsigned i, unsigned per_tick)
+{
+    struct GrvxMissileLaunch m = {
+        .t_start = tick + (i + .5) / per_tick,
+        .dt_ping = 1. + .1 * (i % 7),
+        .dt_end = 2.,
+        .v = .8,
+        .psi = .7 * (tick * per_tick + i),
+    };
+    return m;
+}
+
+static void bench_request_launch(struct Bench *bench, unsigned n_planets)
+{
+    const char *name = "game_request_launch";
+    if (!selected(bench, name)) {
+        return;
+    }
+
+    const unsigned N = 1000;
+    GrvxPlanetsHandle planets = new_universe(n_planets);
+
+    // games are recreated s.t. the number of missiles in flight is bounded
+    struct Result r = {.ops = 0, .seconds = 0.};
+    do {
+        GrvxGameHandle game = grvx_init_game(planets);
+        const double t0 = now();
+        for (unsigned i = 0; i < N; i++) {
+            struct GrvxMissileLaunch m = game_launch(0, i, N);
+            grvx_request_launch(game, i % n_planets, &m, .1);
+        }
+        r.seconds += now() - t0;
+        r.ops += N;
+        grvx_delete_game(game);
+    } while (r.seconds < bench->opts->min_time);
+
+    snprintf(r.params, sizeof(r.params), "\"n_planets\": %u", n_planets);
+    r.unit = "launch";
+    report(bench, name, &r);
+
+    grvx_delete_planets(planets);
+}
+
+static void
+bench_game_loop(struct Bench *bench, unsigned n_planets, unsigned per_tick)
+{
+    const char *name = "game_loop";
+    if (!selected(bench, name)) {
+        return;
+    }
+
+    GrvxPlanetsHandle planets = new_universe(n_planets);
+    GrvxGameHandle game = grvx_init_game(planets);
+
+    // warm-up until the number of missiles in flight has settled
+    const unsigned n_warm_up = 3;
+    struct Result r = {.ops = 0, .seconds = 0.};
+    unsigned long long n_obs = 0;
+    unsigned tick = 0;
+    double t0 = now();
+    while (tick <= n_warm_up || r.seconds < bench->opts->min_time) {
+        if (tick == n_warm_up) {
+            r.ops = 0;
+            n_obs = 0;
+            t0 = now();
+        }
+
+        for (unsigned i = 0; i < per_tick; i++) {
+            struct GrvxMissileLaunch m = game_launch(tick, i, per_tick);
+            grvx_request_launch(game, i % n_planets, &m, .1);
+        }
+
+        while (grvx_observe_or_tick(game, &tick) != NULL) {
+            n_obs += 1;
+        }
+        r.ops += 1;
+        r.seconds = now() - t0;
+    }
+
+    snprintf(r.params,
+             sizeof(r.params),
+             "\"n_planets\": %u, \"launches_per_tick\": %u, "
+             "\"observations_per_tick\": %.1f",
+             n_planets,
+             per_tick,
+             (double)n_obs / (double)r.ops);
+    r.unit = "tick";
+    report(bench, name, &r);
+
+    grvx_delete_game(game);
+    grvx_delete_planets(planets);
+}
+
+static bool parse_options(int argc, char **argv, struct Options *opts)
+{
+    opts->min_time = .5;
+    opts->filter = NULL;
+    opts->out = stdout;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 == argc) {
+            return false;
+        }
+
+        if (strcmp(argv[i], "-t") == 0) {
+            opts->min_time = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "-f") == 0) {
+            opts->filter = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0) {
+            opts->out = fopen(argv[++i], "w");
+            if (opts->out == NULL) {
+                perror(argv[i]);
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    struct Options opts;
+    if (!parse_options(argc, argv, &opts)) {
+        fprintf(stderr,
+                "Usage: %s [-t min_time] [-f filter] [-o output.json]\n",
+                argv[0]);
+        return 1;
+    }
+
+    struct GrvxConfig *cfg = grvx_get_config();
+    fprintf(opts.out,
+            "{\n  \"library\": \"libgravix2\",\n  \"version\": \"%s\",\n"
+            "  \"config\": {\"pot_type\": \"%s\", \"n_pot\": %d, "
+            "\"composition_scheme\": \"%s\", \"n_stages\": %d, "
+            "\"trajectory_size\": %d, \"int_steps\": %d, \"min_dist\": %g},\n"
+            "  \"min_time\": %g,\n  \"benchmarks\": [",
+            grvx_version(),
+            cfg->pot_type,
+            cfg->n_pot,
+            cfg->composition_scheme,
+            cfg->n_stages,
+            cfg->trajectory_size,
+            cfg->int_steps,
+            cfg->min_dist,
+            opts.min_time);
+
+    struct Bench bench = {&opts, true};
+    bench_integration_step(&bench, cfg);
+
+    const unsigned n_planets[] = {1, 4, 16, 64, 256, 1024};
+    for (unsigned i = 0; i < sizeof(n_planets) / sizeof(n_planets[0]); i++) {
+        bench_gradV(&bench, cfg, "direct", n_planets[i]);
+    }
+    bench_gradV(&bench, cfg, "tree", 1024);
+    bench_gradV(&bench, cfg, "field", 1024);
+
+    bench_propagate_missile(&bench, 4);
+    bench_propagate_missile(&bench, 64);
+    bench_request_launch(&bench, 16);
+    bench_game_loop(&bench, 16, 2);
+    bench_game_loop(&bench, 16, 8);
+
+    fprintf(opts.out, "\n  ]\n}\n");
+
+    grvx_free_config(cfg);
+    if (opts.out != stdout) {
+        fclose(opts.out);
+    }
+
+    return 0;
+}
@@ -1,14 +1,19 @@
 import ctypes
 from ctypes import c_double, c_int, c_uint, c_void_p, POINTER
 from dataclasses import dataclass
-from typing import Sequence, Union
+from typing import Callable, Optional, Sequence, Tuple, Union
 
 import numpy as np
 from numpy.typing import ArrayLike
 
+from .config import get_config
 from .helper import Helper
 from .planet import Planets
 
+_DoubleArray = np.ctypeslib.ndpointer(dtype=np.float64, flags="C_CONTIGUOUS")
+_UIntArray = np.ctypeslib.ndpointer(dtype=np.uint32, flags="C_CONTIGUOUS")
+_IntArray = np.ctypeslib.ndpointer(dtype=np.int32, flags="C_CONTIGUOUS")
+
 
 @dataclass(eq=False, order=False, frozen=True)
 class Trajectory:
@@ -34,13 +39,33 @@ class Missile:
 
     :param missile: Missile
     :param lib: ``libgravix2`` library
+    :param x: View of shape ``(GRVX_TRAJECTORY_SIZE, 3)`` on the positions of the
+              missile. If ``None``, the view is created from ``missile``.
+    :param v: View of shape ``(GRVX_TRAJECTORY_SIZE, 3)`` on the velocities of the
+              missile. If ``None``, the view is created from ``missile``.
     """
 
-    def __init__(self, *, missile: c_void_p, lib: ctypes.CDLL) -> None:
+    def __init__(
+        self,
+        *,
+        missile: c_void_p,
+        lib: ctypes.CDLL,
+        x: Optional[np.ndarray] = None,
+        v: Optional[np.ndarray] = None,
+    ) -> None:
         self.is_initialized = False
         self._missile = missile
         self._trajectory = None
 
+        if x is None or v is None:
+            size = get_config(lib=lib).trajectory_size
+            raw = (c_double * (2 * size * 3)).from_address(missile)
+            xv = np.ctypeslib.as_array(raw).reshape(2, size, 3)
+            x, v = xv[0], xv[1]
+
+        self._x = x
+        self._v = v
+
         init = lib.grvx_init_missile
         init.argtypes = [c_void_p, c_double, c_double, c_double, c_double, c_double]
         init.restype = c_int
@@ -134,7 +159,9 @@ class Missile:
         """
         Wrapper for ``libgravix2``'s ``grvx_propagate_missile()`` function
 
-        On success the :func:`gravix2.missile.Missile.propagate` is filled.
+        On success the :func:`gravix2.missile.Missile.trajectory` is filled with
+        views on the underlying memory. Note that these views are overwritten by
+        subsequent calls.
 
         :param planets: The planets
         :param h: The step size
@@ -149,21 +176,43 @@ class Missile:
         )
         premature = premature.value == 1
 
-        class _Trajectory(ctypes.Structure):
-            _fields_ = [
-                ("x", c_double * (n * 3)),
-                ("v", c_double * (n * 3)),
-            ]
-
-        raw = ctypes.cast(self._missile, POINTER(_Trajectory))
-        self._trajectory = Trajectory(
-            np.ctypeslib.as_array(raw.contents.x).reshape(n, 3),
-            np.ctypeslib.as_array(raw.contents.v).reshape(n, 3),
-        )
+        # views on the first n points of the trajectory, no data is copied
+        self._trajectory = Trajectory(self._x[:n], self._v[:n])
 
         return premature
 
 
+class _BatchMemory:
+    """
+    Owner of the memory of a ``GrvxTrajectoryBatch``
+
+    Exposes the batch via NumPy's array interface. Since NumPy keeps a reference to
+    the exporting object in the ``base`` of each view, the memory is freed only after
+    the last view is gone.
+
+    :param handle: The batch handle
+    :param n: Number of missiles
+    :param size: Same as ``GRVX_TRAJECTORY_SIZE``
+    :param delete_missiles: ``libgravix2``'s ``grvx_delete_missiles()``
+    """
+
+    def __init__(
+        self, handle: int, *, n: int, size: int, delete_missiles: Callable[[int], None]
+    ) -> None:
+        self.handle = handle
+        self._delete_missiles = delete_missiles
+        self.__array_interface__ = {
+            "shape": (n, 2, size, 3),
+            "typestr": np.dtype(np.float64).str,
+            "data": (handle, False),
+            "version": 3,
+        }
+
+    def __del__(self) -> None:
+        if self.handle is not None:
+            self._delete_missiles(self.handle)
+
+
 class Missiles:
     """
     A sequence of :class:`gravix2.missile.Missile` corresponding to ``libgravix``'s
@@ -185,6 +234,10 @@ class Missiles:
         m[0].propagate(planets, h=1e-3)
         ...
 
+    The trajectories of all missiles are also exposed as NumPy arrays without
+    copying, see :func:`gravix2.missile.Missiles.x` and
+    :func:`gravix2.missile.Missiles.v`.
+
     Use :func:`gravix2.Gravix2.new_missiles` to create a new sequence of instances.
 
     :param n: Number of missiles
@@ -193,24 +246,166 @@ class Missiles:
 
     def __init__(self, n: int, *, lib: ctypes.CDLL) -> None:
         n = int(n)
+        size = get_config(lib=lib).trajectory_size
 
         new_missiles = lib.grvx_new_missiles
         new_missiles.argtypes = [c_uint]
         new_missiles.restype = c_void_p
-        self._handle = new_missiles(n)
+
+        delete_missiles = lib.grvx_delete_missiles
+        delete_missiles.argtypes = [c_void_p]
+        delete_missiles.restype = None
+
+        # at least one missile is allocated s.t. the data pointer is never NULL
+        self._memory = _BatchMemory(
+            new_missiles(max(n, 1)),
+            n=n,
+            size=size,
+            delete_missiles=delete_missiles,
+        )
+        self._handle = self._memory.handle
+
+        xv = np.asarray(self._memory)
+        self._x = xv[:, 0]
+        self._v = xv[:, 1]
 
         getter = lib.grvx_get_trajectory
         getter.argtypes = [c_void_p, c_uint]
         getter.restype = c_void_p
 
         self._missiles = [
-            Missile(missile=getter(self._handle, i), lib=lib) for i in range(n)
+            Missile(
+                missile=getter(self._handle, i),
+                lib=lib,
+                x=self._x[i],
+                v=self._v[i],
+            )
+            for i in range(n)
         ]
 
-        delete_missiles = lib.grvx_delete_missiles
-        delete_missiles.argtypes = [c_void_p]
-        delete_missiles.restype = None
-        self._delete_missiles = delete_missiles
+        launch = lib.grvx_launch_missiles
+        launch.argtypes = [
+            c_void_p,
+            c_uint,
+            c_void_p,
+            _UIntArray,
+            _DoubleArray,
+            _DoubleArray,
+        ]
+        launch.restype = c_int
+        self._launch = launch
+
+        propagate = lib.grvx_propagate_missiles
+        propagate.argtypes = [
+            c_void_p,
+            c_uint,
+            c_void_p,
+            c_double,
+            _UIntArray,
+            _IntArray,
+        ]
+        propagate.restype = None
+        self._propagate = propagate
+
+    @property
+    def handle(self) -> int:
+        """
+        The handle of ``libgravix2``'s ``GrvxTrajectoryBatch``
+
+        :return: The handle
+        """
+        return self._handle
+
+    @property
+    def x(self) -> np.ndarray:
+        """
+        Positions of all missiles
+
+        A view of shape ``(n, GRVX_TRAJECTORY_SIZE, 3)`` on the memory of the batch,
+        i.e., the array is updated in place by subsequent propagation calls and keeps
+        the memory of the batch alive. Note that only the first points of each
+        trajectory are updated by a propagation call, cf. ``libgravix2``'s
+        ``grvx_propagate_missile()``.
+
+        :return: The positions in Cartesian coordinates
+        """
+        return self._x
+
+    @property
+    def v(self) -> np.ndarray:
+        """
+        Velocities of all missiles
+
+        Same as :func:`gravix2.missile.Missiles.x` but for the velocities.
+
+        :return: The velocities in Cartesian coordinates
+        """
+        return self._v
+
+    def launch(
+        self, *, planets: Planets, planet_idx: ArrayLike, v: ArrayLike, psi: ArrayLike
+    ) -> None:
+        """
+        Wrapper for ``libgravix2``'s ``grvx_launch_missiles()`` function
+
+        Launches the first ``n`` missiles at once, where ``n`` is the common
+        (broadcast) length of the arguments. See
+        :func:`gravix2.missile.Missile.launch` for the meaning of the parameters.
+
+        :param planets: The planets
+        :param planet_idx: The planet indices (not IDs)
+        :param v: Initial velocities
+        :param psi: Initial azimuthal positions
+        :return: None
+        """
+        planet_idx, v, psi = np.broadcast_arrays(planet_idx, v, psi)
+        if planet_idx.ndim != 1 or len(planet_idx) > len(self):
+            raise ValueError(f"Expected at most {len(self)} missiles")
+
+        n = len(planet_idx)
+        rc = self._launch(
+            self._handle,
+            n,
+            planets.handle,
+            np.ascontiguousarray(planet_idx, dtype=np.uint32),
+            np.ascontiguousarray(v, dtype=np.float64),
+            np.ascontiguousarray(psi, dtype=np.float64),
+        )
+        if rc != 0:
+            raise RuntimeError("Launching missiles failed")
+
+        for m in self._missiles[:n]:
+            m.is_initialized = True
+
+    def propagate(
+        self, planets: Planets, *, h: float, n: Optional[int] = None
+    ) -> Tuple[np.ndarray, np.ndarray]:
+        """
+        Wrapper for ``libgravix2``'s ``grvx_propagate_missiles()`` function
+
+        Propagates the first ``n`` missiles at once. The trajectories are written
+        into :func:`gravix2.missile.Missiles.x` and
+        :func:`gravix2.missile.Missiles.v`, whereas
+        :func:`gravix2.missile.Missile.trajectory` is not updated.
+
+        :param planets: The planets
+        :param h: The step size
+        :param n: Number of missiles. If ``None``, all missiles are propagated.
+        :return: Number of valid points of each trajectory and flags indicating
+                 whether propagation was stopped prematurely
+        """
+        n = len(self) if n is None else int(n)
+        if n < 0 or n > len(self):
+            raise ValueError(f"Expected at most {len(self)} missiles")
+
+        if not all(m.is_initialized for m in self._missiles[:n]):
+            raise RuntimeError("Missile is not initialized")
+
+        n_steps = np.zeros(n, dtype=np.uint32)
+        premature = np.zeros(n, dtype=np.int32)
+        self._propagate(self._handle, n, planets.handle, float(h), n_steps, premature)
+
+        return n_steps, premature != 0
 
     def __len__(self) -> int:
         return len(self._missiles)
@@ -223,6 +418,3 @@ class Missiles:
         :return: The missile
         """
         return self._missiles[i]
-
-    def __del__(self) -> None:
-        self._delete_missiles(self._handle)
@@ -3,8 +3,13 @@ import random
 from ctypes import c_double, c_int, c_uint, c_void_p, POINTER
 from typing import List, Optional, Sequence, Tuple, Union
 
+import numpy as np
+from numpy.typing import ArrayLike
+
 from .extensions.game import Game
 
+_DoubleArray = np.ctypeslib.ndpointer(dtype=np.float64, flags="C_CONTIGUOUS")
+
 
 class Planets:
     """
@@ -64,24 +69,9 @@ class Planets:
             self.handle = new_planets(planets)
             rnd_init(self.handle, ctypes.byref(seed), c_double(min_dist))
 
-            get_planet = lib.grvx_get_planet
-            get_planet.argtypes = [
-                c_void_p,
-                c_uint,
-                POINTER(c_double),
-                POINTER(c_double),
-            ]
-            get_planet.restype = c_int
-
-            self._planet_pos = []
-            for i in range(planets):
-                lat, lon = c_double(), c_double()
-                rc = get_planet(
-                    self.handle, c_uint(i), ctypes.byref(lat), ctypes.byref(lon)
-                )
-                assert rc == 0
-
-                self._planet_pos.append((lat.value, lon.value))
+            self._init_bulk_access()
+            lat, lon = self.get_planet_pos()
+            self._planet_pos = list(zip(lat.tolist(), lon.tolist()))
 
         else:
             if min_dist is not None:
@@ -96,16 +86,12 @@ class Planets:
                     "`seed` is ignored"
                 )
 
-            set_planet = lib.grvx_set_planet
-            set_planet.argtypes = [c_void_p, c_uint, c_double, c_double]
-            set_planet.restype = c_int
-
             self.handle = new_planets(len(planets))
-            for i, (lat, lon) in enumerate(planets):
-                rc = set_planet(self.handle, i, float(lat), float(lon))
-                assert rc == 0
-
             self._planet_pos = list(planets)
+            self._init_bulk_access()
+            if len(planets) > 0:
+                lat, lon = np.array(planets, dtype=np.float64).T
+                self.set_planet_pos(lat, lon)
 
         self._planet_id = list(range(len(self._planet_pos)))
 
@@ -130,6 +116,63 @@ class Planets:
         perturb_measurement.restype = None
         self._perturb_measurement = perturb_measurement
 
+    def _init_bulk_access(self) -> None:
+        count_planets = self.lib.grvx_count_planets
+        count_planets.argtypes = [c_void_p]
+        count_planets.restype = c_uint
+        self._count_planets = count_planets
+
+        set_planets = self.lib.grvx_set_planets
+        set_planets.argtypes = [c_void_p, c_uint, _DoubleArray, _DoubleArray]
+        set_planets.restype = c_int
+        self._set_planets = set_planets
+
+        get_planets = self.lib.grvx_get_planets
+        get_planets.argtypes = [c_void_p, c_uint, _DoubleArray, _DoubleArray]
+        get_planets.restype = c_int
+        self._get_planets = get_planets
+
+    def set_planet_pos(self, lat: ArrayLike, lon: ArrayLike) -> None:
+        """
+        Moves all planets at once
+
+        Wrapper for ``libgravix2``'s ``grvx_set_planets()`` function. The i-th
+        elements of ``lat`` and ``lon`` refer to the planet with index i.
+
+        :param lat: Latitudes of all planets
+        :param lon: Longitudes of all planets
+        :return: None
+        """
+        lat = np.ascontiguousarray(lat, dtype=np.float64)
+        lon = np.ascontiguousarray(lon, dtype=np.float64)
+        if lat.shape != (len(self),) or lon.shape != (len(self),):
+            raise ValueError(f"Expected {len(self)} latitudes and longitudes")
+
+        rc = self._set_planets(self.handle, len(self), lat, lon)
+        if rc != 0:
+            raise RuntimeError("Setting planets failed")
+
+        self._planet_pos = list(zip(lat.tolist(), lon.tolist()))
+
+    def get_planet_pos(self) -> Tuple[np.ndarray, np.ndarray]:
+        """
+        Retrieves the positions of all planets at once
+
+        Wrapper for ``libgravix2``'s ``grvx_get_planets()`` function. In contrast to
+        :func:`gravix2.planet.Planets.planet_pos`, the positions are read from
+        ``libgravix2`` and thus reflect rounding errors of the internal
+        representation.
+
+        :return: Latitudes and longitudes ordered by index
+        """
+        n = self._count_planets(self.handle)
+        lat = np.empty(n, dtype=np.float64)
+        lon = np.empty(n, dtype=np.float64)
+        rc = self._get_planets(self.handle, n, lat, lon)
+        assert rc == 0
+
+        return lat, lon
+
     @property
     def planet_id(self) -> List[int]:
         """
@@ -1,3 +1,9 @@
+import gc
+
+import numpy as np
+import pytest
+
+from src.gravix2.config import get_config
 from src.gravix2.missile import Missiles
 from src.gravix2.planet import Planets
 
@@ -19,3 +25,63 @@ def test_missiles(libgravix2):
         premature = m.propagate(planets=planets, h=1e-4)
         assert premature
         assert m.trajectory.x.shape == m.trajectory.v.shape
+
+
+def test_trajectory_views(libgravix2):
+    planets = Planets([(0.0, 0.0)], lib=libgravix2)
+    size = get_config(lib=libgravix2).trajectory_size
+
+    missiles = Missiles(n=3, lib=libgravix2)
+    assert missiles.x.shape == (3, size, 3)
+    assert missiles.v.shape == (3, size, 3)
+
+    for i, m in enumerate(missiles):
+        m.launch(planets=planets, planet_idx=0, v=0.5, psi=float(i))
+        m.propagate(planets=planets, h=1e-3)
+
+        n = len(m.trajectory.x)
+        assert np.shares_memory(m.trajectory.x, missiles.x)
+        assert np.array_equal(m.trajectory.x, missiles.x[i, :n])
+        assert np.array_equal(m.trajectory.v, missiles.v[i, :n])
+        assert np.allclose(np.linalg.norm(missiles.x[i, :n], axis=1), 1.0)
+
+    # views keep the batch alive
+    x = missiles.x
+    expected = x.copy()
+    del missiles
+    gc.collect()
+    assert np.array_equal(x, expected)
+
+
+def test_bulk_launch_and_propagate(libgravix2):
+    planets = Planets([(0.0, 0.0), (0.5, 1.0)], lib=libgravix2)
+    n = 5
+    planet_idx = np.array([0, 1, 0, 1, 1])
+    v = np.linspace(0.1, 0.5, n)
+    psi = np.linspace(-1.0, 1.0, n)
+
+    single = Missiles(n=n, lib=libgravix2)
+    for i, m in enumerate(single):
+        m.launch(planets=planets, planet_idx=int(planet_idx[i]), v=v[i], psi=psi[i])
+        m.propagate(planets=planets, h=1e-3)
+
+    bulk = Missiles(n=n, lib=libgravix2)
+    with pytest.raises(RuntimeError):
+        bulk.propagate(planets, h=1e-3)
+    with pytest.raises(RuntimeError):
+        bulk.launch(planets=planets, planet_idx=[0, 2, 0, 1, 1], v=v, psi=psi)
+
+    bulk.launch(planets=planets, planet_idx=planet_idx, v=v, psi=psi)
+    n_steps, premature = bulk.propagate(planets, h=1e-3)
+    assert n_steps.shape == premature.shape == (n,)
+
+    for i, m in enumerate(single):
+        k = len(m.trajectory.x)
+        assert n_steps[i] == k
+        assert np.allclose(bulk.x[i, :k], m.trajectory.x)
+        assert np.allclose(bulk.v[i, :k], m.trajectory.v)
+
+    # scalars are broadcast
+    bulk.launch(planets=planets, planet_idx=0, v=[0.1, 0.2], psi=0.0)
+    n_steps, _ = bulk.propagate(planets, h=1e-3, n=2)
+    assert n_steps.shape == (2,)
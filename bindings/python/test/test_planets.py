@@ -44,3 +44,23 @@ def test_planets(libgravix2):
 
     planets.remove_planet(0)
     assert len(planets.planet_id) == 0
+
+
+def test_bulk_planet_pos(libgravix2):
+    planets = Planets(planets=[(0.1, 0.2), (-0.3, 0.4), (0.5, -2.6)], lib=libgravix2)
+    lat, lon = planets.get_planet_pos()
+    assert np.allclose(lat, [0.1, -0.3, 0.5])
+    assert np.allclose(lon, [0.2, 0.4, -2.6])
+
+    planets.set_planet_pos(np.array([0.0, 1.0, -1.0]), np.array([3.0, 0.0, -0.5]))
+    lat, lon = planets.get_planet_pos()
+    assert np.allclose(lat, [0.0, 1.0, -1.0])
+    assert np.allclose(lon, [3.0, 0.0, -0.5])
+    assert np.allclose(planets.planet_pos, [(0.0, 3.0), (1.0, 0.0), (-1.0, -0.5)])
+
+    with pytest.raises(ValueError):
+        planets.set_planet_pos([0.0, 1.0], [0.0, 1.0])
+
+    planets.remove_planet(2)
+    lat, lon = planets.get_planet_pos()
+    assert lat.shape == lon.shape == (2,)
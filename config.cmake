@@ -11,9 +11,11 @@ if(${GRVX_POT_TYPE_INDEX} EQUAL -1)
 endif()
 
 if("${GRVX_POT_TYPE}" STREQUAL "3D")
-    set(GRVX_N_POT "2" CACHE STRING "Approximation order of potential")
+    set(GRVX_N_POT "2" CACHE STRING "Approximation order of potential (0 for infinite order)")
+    set(GRVX_POT_TABLE_SIZE "256" CACHE STRING "Number of intervals of the tabulated force (0 disables the table)")
 else()
     set(GRVX_N_POT "???")
+    set(GRVX_POT_TABLE_SIZE "???")
 endif()
 
 set(GRVX_COMPOSITION_SCHEME "p8s15" CACHE STRING "Composition method of integrator")
@@ -35,4 +37,21 @@ elseif("${GRVX_COMPOSITION_SCHEME}" STREQUAL "p8s15")
     set(GRVX_COMPOSITION_STAGES "15")
 else()
     message(FATAL_ERROR "Unkown composition method '${GRVX_COMPOSITION_SCHEME}'")
-endif()
\ No newline at end of file
+endif()
+
+set(GRVX_SIMD "generic" CACHE STRING "Instruction set targeted by the batch propagation engine")
+set_property(CACHE GRVX_SIMD PROPERTY STRINGS "generic" "avx2" "avx512")
+if("${GRVX_SIMD}" STREQUAL "generic")
+    set(GRVX_SIMD_LANES "4")
+    set(GRVX_SIMD_FLAGS "")
+elseif("${GRVX_SIMD}" STREQUAL "avx2")
+    set(GRVX_SIMD_LANES "4")
+    set(GRVX_SIMD_FLAGS "-mavx2")
+elseif("${GRVX_SIMD}" STREQUAL "avx512")
+    set(GRVX_SIMD_LANES "8")
+    set(GRVX_SIMD_FLAGS "-mavx512f")
+else()
+    message(FATAL_ERROR "Unkown instruction set '${GRVX_SIMD}'")
+endif()
+
+option(GRVX_STATS "Collect runtime statistics (see grvx_get_stats())" OFF)
@@ -0,0 +1,217 @@
+/*!
+ * \file field.h
+ * \brief Precomputed force field of a static set of planets.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \brief Largest number of bins per edge of a face of GrvxField.
+ */
+#define GRVX_FIELD_MAX_BINS 256
+
+/*!
+ * \brief Force field sampled on a grid (baked field).
+ *
+ * The force of each planet is split by a smooth window \f$w\f$ into a singular
+ * near part \f$w F\f$, which vanishes beyond the angular distance
+ * \f$r_\mathrm{near}\f$, and a smooth far part \f$(1 - w) F\f$. The sum of the
+ * far parts of all planets is projected onto the tangent plane and sampled on
+ * the nodes of a cube map, i.e., the sphere is projected onto the six faces of
+ * a cube, each of which is covered by a regular grid of \f$n \times n\f$
+ * cells. Between the nodes the far field is interpolated bilinearly. Nodes on
+ * the edges of the faces are shared by adjacent faces s.t. the interpolation
+ * is continuous.
+ *
+ * The near parts are summed exactly. To this end, the faces are divided into
+ * coarser bins that hold all planets within \f$r_\mathrm{near}\f$ of any point
+ * of the bin, s.t. a single bin has to be visited per evaluation.
+ *
+ * Each node stores three doubles, i.e., the grid occupies
+ * \f$6 (n + 1)^2 \cdot 24\f$ bytes.
+ */
+struct GrvxField {
+    unsigned n;          /*!< Number of cells per edge of a face, \f$n\f$. */
+    double r_near;       /*!< Radius of the near field. */
+    double cos_near;     /*!< Cosine of GrvxField.r_near. */
+    double *f;           /*!< Far field at the nodes (xyz interleaved). */
+    unsigned n_bins;     /*!< Number of bins per edge of a face. */
+    unsigned *bin_start; /*!< First planet of each bin (+1 sentinel). */
+    double *x;           /*!< First components of the planets in bin order. */
+    double *y;           /*!< Second components of the planets in bin order. */
+    double *z;           /*!< Third components of the planets in bin order. */
+};
+
+/*!
+ * \brief Location of a point on the cube map of GrvxField.
+ */
+struct GrvxFieldCoord {
+    unsigned face; /*!< Face of the cube map. */
+    double u;      /*!< First coordinate on the face in \f$[-1, 1]\f$. */
+    double v;      /*!< Second coordinate on the face in \f$[-1, 1]\f$. */
+};
+
+/*!
+ * \brief Initializes a field and bins the planets.
+ *
+ * The far field is initialized with zeros and has to be sampled afterwards,
+ * e.g., by grvx_sample_field().
+ *
+ * @param field The field.
+ * @param x First components of the positions of the planets.
+ * @param y Second components of the positions of the planets.
+ * @param z Third components of the positions of the planets.
+ * @param n Number of planets.
+ * @param resolution Number of cells per edge of a face, \f$n > 0\f$.
+ * @param r_near Radius of the near field, \f$0 < r_\mathrm{near} < \pi / 2\f$.
+ */
+void grvx_field_init(struct GrvxField *field,
+                     const double *x,
+                     const double *y,
+                     const double *z,
+                     unsigned n,
+                     unsigned resolution,
+                     double r_near);
+
+/*!
+ * \brief Frees the memory of a field.
+ *
+ * @param field The field.
+ */
+void grvx_field_free(struct GrvxField *field);
+
+/*!
+ * \brief Number of nodes of a field.
+ *
+ * @param field The field.
+ * @return Number of nodes.
+ */
+static inline unsigned grvx_field_size(const struct GrvxField *field)
+{
+    return 6 * (field->n + 1) * (field->n + 1);
+}
+
+/*!
+ * \brief Position of a node of a field.
+ *
+ * @param field The field.
+ * @param k Index of the node, \f$k < \f$ grvx_field_size().
+ * @param q Set to the Cartesian coordinates of the node on the unit sphere.
+ */
+void grvx_field_node(const struct GrvxField *field, unsigned k, double q[3]);
+
+/*!
+ * \brief Locates a point on the cube map.
+ *
+ * @param q Cartesian coordinates of a point on the unit sphere.
+ * @return The location.
+ */
+static inline struct GrvxFieldCoord grvx_field_locate(const double q[3])
+{
+    const double ax = q[0] < 0. ? -q[0] : q[0];
+    const double ay = q[1] < 0. ? -q[1] : q[1];
+    const double az = q[2] < 0. ? -q[2] : q[2];
+
+    // the face is perpendicular to the largest component
+    const unsigned a = ax >= ay ? (ax >= az ? 0 : 2) : (ay >= az ? 1 : 2);
+    const unsigned b = a == 2 ? 0 : a + 1;
+    const unsigned c = a == 0 ? 2 : a - 1;
+    const double inv = 1. / (a == 0 ? ax : a == 1 ? ay : az);
+
+    struct GrvxFieldCoord coord = {
+        2 * a + (q[a] < 0.), q[b] * inv, q[c] * inv};
+    return coord;
+}
+
+/*!
+ * \brief Interpolates the far field.
+ *
+ * @param field The field.
+ * @param coord Location of the point, cf. grvx_field_locate().
+ * @param f Set to the interpolated far field.
+ */
+static inline void grvx_field_interpolate(const struct GrvxField *field,
+                                          struct GrvxFieldCoord coord,
+                                          double f[3])
+{
+    const unsigned n = field->n;
+    const double gu = (coord.u + 1.) * .5 * n;
+    const double gv = (coord.v + 1.) * .5 * n;
+
+    unsigned i = gu > 0. ? (unsigned)gu : 0;
+    unsigned j = gv > 0. ? (unsigned)gv : 0;
+    i = i < n ? i : n - 1;
+    j = j < n ? j : n - 1;
+    const double tu = gu - (double)i;
+    const double tv = gv - (double)j;
+
+    const unsigned stride = n + 1;
+    const double *f00 = &field->f[3 * ((coord.face * stride + i) * stride + j)];
+    const double *f01 = f00 + 3;
+    const double *f10 = f00 + 3 * stride;
+    const double *f11 = f10 + 3;
+
+    const double w00 = (1. - tu) * (1. - tv);
+    const double w01 = (1. - tu) * tv;
+    const double w10 = tu * (1. - tv);
+    const double w11 = tu * tv;
+    for (unsigned k = 0; k < 3; k++) {
+        f[k] = w00 * f00[k] + w01 * f01[k] + w10 * f10[k] + w11 * f11[k];
+    }
+}
+
+/*!
+ * \brief Bin of a point.
+ *
+ * The planets of bin \f$b\f$ are found at indices
+ * \f$[\f$GrvxField.bin_start[b], GrvxField.bin_start[b + 1]\f$)\f$.
+ *
+ * @param field The field.
+ * @param coord Location of the point, cf. grvx_field_locate().
+ * @return Index of the bin.
+ */
+static inline unsigned grvx_field_bin(const struct GrvxField *field,
+                                      struct GrvxFieldCoord coord)
+{
+    const unsigned n = field->n_bins;
+    const double gu = (coord.u + 1.) * .5 * n;
+    const double gv = (coord.v + 1.) * .5 * n;
+
+    unsigned i = gu > 0. ? (unsigned)gu : 0;
+    unsigned j = gv > 0. ? (unsigned)gv : 0;
+    i = i < n ? i : n - 1;
+    j = j < n ? j : n - 1;
+    return (coord.face * n + i) * n + j;
+}
+
+/*!
+ * \brief Weight of the far part of the force of a planet.
+ *
+ * The weight rises from zero to one between the position of the planet and
+ * \f$r_\mathrm{near}\f$ as a quintic polynomial in \f$t = (1 - d) / (1 -
+ * \cos r_\mathrm{near})\f$, where \f$d\f$ is the cosine of the distance. Since
+ * \f$1 - w \sim t^3\f$ for small distances, the far part of the force is (at
+ * least) twice differentiable for both potentials.
+ *
+ * @param field The field.
+ * @param d Cosine of the angle between a position and the planet.
+ * @return The weight \f$1 - w\f$.
+ */
+static inline double grvx_field_far_weight(const struct GrvxField *field,
+                                           double d)
+{
+    if (d <= field->cos_near) {
+        return 1.;
+    }
+
+    const double t = (1. - d) / (1. - field->cos_near);
+    return t * t * t * (10. + t * (-15. + t * 6.));
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
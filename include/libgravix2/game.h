@@ -27,11 +27,16 @@
  * Time is represented by ticks and is advanced via grvx_observe_or_tick(). A
  * tick is an integer, however, observable events are represented as fractions
  * of ticks.
+ *
+ * Servers that run many games at once can hand them to a game host (see
+ * grvx_new_game_host()), which advances all of its games by one tick per round
+ * on a shared pool of worker threads.
  */
 
 #pragma once
 
 #include "libgravix2/api.h"
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -144,10 +149,20 @@ struct GrvxMissileObservation {
  * number equals at least the number of planets and is larger whenever
  * additional draws were needed.
  *
+ * Each draw is only compared to the planets placed in its vicinity, which are
+ * looked up on a grid of cells on the sphere. Hence, initializing takes
+ * (amortized) constant time per draw and memory proportional to the number of
+ * planets.
+ *
  * The seed is updated by each draw such that two consecutive calls to
  * grvx_rnd_init_planets() (w/o resetting \p seed) will return different
  * results.
  *
+ * Draws come from a Park-Miller generator with a period of \f$2^{31} - 2\f$.
+ * Earlier versions overflowed its 32-bit product, which limited the period to
+ * about 30k draws, i.e., the universe generated for a given seed differs from
+ * the one of these versions.
+ *
  * If \p min_dist is chosen too large, initializing can cause many iterations
  * and can even block indefinitely. As a rule of thumb,
  * \f$\cos d/2 \gg 1 - 2/n\f$ or \f$d \ll 4 / \sqrt{n}\f$ where \f$d\f$ is
@@ -164,6 +179,80 @@ GRVX_EXPORT int32_t grvx_rnd_init_planets(GrvxPlanetsHandle planets,
                                           uint32_t *seed,
                                           double min_dist);
 
+/*!
+ * \brief Counter-based random number generator.
+ *
+ * The \f$i\f$-th number of a generator is a pure function of its key and
+ * \f$i\f$, i.e., the generator is advanced by any number of draws in constant
+ * time by adding to GrvxRng::counter. Independent generators (streams) are
+ * derived from a single seed by grvx_split_rng(), e.g., one per game, per
+ * planet, or per Monte Carlo sample, s.t. work that is distributed over
+ * threads yields the same numbers regardless of the order of execution.
+ *
+ * The numbers equal those of SplitMix64 started at the key.
+ */
+struct GrvxRng {
+    uint64_t key;     /*!< Identifies the stream. */
+    uint64_t counter; /*!< Number of draws so far. */
+};
+
+/*!
+ * \brief Initializes a random number generator.
+ *
+ * @param seed The seed.
+ * @return The generator.
+ */
+GRVX_EXPORT struct GrvxRng grvx_init_rng(uint64_t seed);
+
+/*!
+ * \brief Derives an independent random number generator.
+ *
+ * The derived generator only depends on the key of \p rng and on \p stream,
+ * i.e., not on the number of draws from \p rng. Generators derived for
+ * different streams (or from different keys) are statistically independent
+ * and can be split further.
+ *
+ * @param rng The parent generator.
+ * @param stream Index of the stream.
+ * @return The derived generator.
+ */
+GRVX_EXPORT struct GrvxRng grvx_split_rng(const struct GrvxRng *rng,
+                                          uint64_t stream);
+
+/*!
+ * \brief Draws a random 64 bit word.
+ *
+ * @param rng The generator.
+ * @return The next word of the generator.
+ */
+GRVX_EXPORT uint64_t grvx_rng_next(struct GrvxRng *rng);
+
+/*!
+ * \brief Draws a random number from a uniform distribution.
+ *
+ * @param rng The generator.
+ * @return Number in \f$[0, 1)\f$ with a resolution of \f$2^{-53}\f$.
+ */
+GRVX_EXPORT double grvx_rng_uniform(struct GrvxRng *rng);
+
+/*!
+ * \brief Initializes planets randomly with a counter-based generator.
+ *
+ * Same as grvx_rnd_init_planets() but positions are drawn from \p rng. The
+ * \f$k\f$-th candidate position is determined by the draws \f$2k\f$ and
+ * \f$2k + 1\f$ of \p rng, i.e., universes do not depend on any state shared
+ * with other universes, and \p rng is advanced by twice the number of
+ * candidates.
+ *
+ * @param planets The planets handle.
+ * @param rng The generator, e.g., derived by grvx_split_rng() per universe.
+ * @param min_dist Minimum distance between two planets.
+ * @return Number of random draws from the distribution.
+ */
+GRVX_EXPORT int32_t grvx_rng_init_planets(GrvxPlanetsHandle planets,
+                                          struct GrvxRng *rng,
+                                          double min_dist);
+
 /*!
  * \brief Initializes a new game from a set of planets.
  *
@@ -177,12 +266,31 @@ GRVX_EXPORT int32_t grvx_rnd_init_planets(GrvxPlanetsHandle planets,
  */
 GRVX_EXPORT GrvxGameHandle grvx_init_game(GrvxPlanetsHandle planets);
 
+/*!
+ * \brief Initializes a new game with a fixed capacity.
+ *
+ * Same as grvx_init_game() but all memory of the game is allocated upfront in
+ * a single block, which holds up to \p max_flights missiles in flight and
+ * their pending observations. Neither grvx_request_launch() nor
+ * grvx_observe_or_tick() allocate memory for such a game and
+ * grvx_delete_game() releases it at once. Launches that exceed the capacity
+ * are rejected by grvx_request_launch().
+ *
+ * Games restored by grvx_load_game() are not limited in capacity.
+ *
+ * @param planets Set of planets.
+ * @param max_flights Maximum number of missiles in flight.
+ * @return Game handle or ``NULL`` if the allocation failed.
+ */
+GRVX_EXPORT GrvxGameHandle grvx_init_game_fixed(GrvxPlanetsHandle planets,
+                                                uint32_t max_flights);
+
 /*!
  * \brief Deletes a game instance.
  *
- * Deletes a game instance that was created with grvx_init_game(), frees
- * allocated memory, and invalidates any pointers to GrvxMissileObservation that
- * were returned by grvx_observe_or_tick().
+ * Deletes a game instance that was created with grvx_init_game() or
+ * grvx_init_game_fixed(), frees allocated memory, and invalidates any pointers
+ * to GrvxMissileObservation that were returned by grvx_observe_or_tick().
  *
  * @param handle The game handle.
  */
@@ -192,7 +300,9 @@ GRVX_EXPORT void grvx_delete_game(GrvxGameHandle handle);
  * \brief Requests a missile launch.
  *
  * Requests the launch of a missile at some future time step (tick.) If the
- * request is accepted, a launch is scheduled at the given planet.
+ * request is accepted, a launch is scheduled at the given planet. The missile
+ * is not propagated here but added to the set of missiles in flight, which are
+ * advanced incrementally by grvx_observe_or_tick().
  *
  * The time step of the integrator, \f$h\f$, is set to the ratio of \p dt over
  * the product of the number of integration steps between trajectory points,
@@ -204,7 +314,8 @@ GRVX_EXPORT void grvx_delete_game(GrvxGameHandle handle);
  * @param planet_id ID of the planet.
  * @param missile Settings of the requested missile launch.
  * @param dt Step size of the simulation.
- * @return Zero on success.
+ * @return Zero on success, and non-zero if the request is invalid or if a
+ * game created by grvx_init_game_fixed() is at capacity.
  */
 GRVX_EXPORT int32_t grvx_request_launch(GrvxGameHandle game,
                                         uint32_t planet_id,
@@ -221,6 +332,10 @@ GRVX_EXPORT int32_t grvx_request_launch(GrvxGameHandle game,
  * If the list is empty, time is advanced by increasing the tick count by one.
  * This updated tick is written to \p t and ``NULL`` is returned.
  *
+ * Missiles in flight are propagated on demand, i.e., only as far as needed to
+ * know all observations up to the next tick. Hence, the costs of propagating
+ * missiles are spread evenly over the ticks of their flights.
+ *
  * The lifetime of the returned observation is managed by the game instance. In
  * particular, calling grvx_observe_or_tick() implicitly invalidates any
  * previous pointers that were returned by grvx_observe_or_tick(). Calling
@@ -234,6 +349,221 @@ GRVX_EXPORT int32_t grvx_request_launch(GrvxGameHandle game,
 GRVX_EXPORT struct GrvxMissileObservation *
 grvx_observe_or_tick(GrvxGameHandle game, uint32_t *t);
 
+/*!
+ * \brief Version of the binary format of grvx_save_game().
+ */
+#define GRVX_GAME_SNAPSHOT_VERSION 1
+
+/*!
+ * \brief Writes a snapshot of a game into a buffer.
+ *
+ * The snapshot holds the complete state of the game, i.e., the current tick,
+ * the planets (including the settings of their force engine, cf.
+ * grvx_set_opening_angle() and grvx_bake_field()), all missiles in flight, and
+ * all pending observations. It is a contiguous block of fixed-size records
+ * without any pointers s.t. it can be written to a file as is and later be
+ * restored from a memory-mapped copy of that file via grvx_load_game().
+ *
+ * Snapshots are tied to the configuration of the library (cf. GrvxConfig) and
+ * to the byte order of the host, since games restored elsewhere would not
+ * continue identically.
+ *
+ * Call with \p size set to zero to query the size of the snapshot.
+ *
+ * @param game The game handle.
+ * @param buffer Buffer of \p size bytes. Can be ``NULL`` if \p size is zero.
+ * @param size Size of the buffer in bytes.
+ * @return Size of the snapshot in bytes. Nothing is written if this exceeds
+ * \p size.
+ */
+GRVX_EXPORT size_t grvx_save_game(GrvxGameHandle game,
+                                  void *buffer,
+                                  size_t size);
+
+/*!
+ * \brief Restores a game from a snapshot.
+ *
+ * Restores a game that was written by grvx_save_game(). The restored game
+ * continues bit-identically to the original one. The snapshot is not referred
+ * to after the call returns.
+ *
+ * Since the game refers to its planets, they are restored as well and the
+ * caller owns both: The game has to be deleted via grvx_delete_game() before
+ * the planets are deleted via grvx_delete_planets().
+ *
+ * @param buffer The snapshot.
+ * @param size Size of the snapshot in bytes.
+ * @param planets Set to the handle of the restored planets.
+ * @return Game handle or ``NULL`` if the snapshot is invalid or was written by
+ * an incompatible version or configuration of the library.
+ */
+GRVX_EXPORT GrvxGameHandle grvx_load_game(const void *buffer,
+                                          size_t size,
+                                          GrvxPlanetsHandle *planets);
+
+struct GrvxGameHost;
+
+/*!
+ * \brief Handle to a game host.
+ *
+ * Game hosts are intentionally opaque in the API and should only be referred
+ * to by their respective handle. Internals are subjects to change.
+ */
+typedef struct GrvxGameHost *GrvxGameHostHandle;
+
+/*!
+ * \brief Results of a hosted game in the last round.
+ *
+ * Filled by grvx_run_host_round() and returned by grvx_host_output(). The
+ * arrays are owned by the host and remain valid until the next round.
+ */
+struct GrvxHostOutput {
+    /*!
+     * \brief Current tick.
+     *
+     * Tick of the game after the round.
+     */
+    uint32_t tick;
+
+    /*!
+     * \brief Number of launch requests.
+     *
+     * Number of launches that were queued by grvx_host_request_launch() before
+     * the round.
+     */
+    uint32_t n_launches;
+
+    /*!
+     * \brief Results of the launch requests.
+     *
+     * Return values of grvx_request_launch() in the order of the requests.
+     */
+    const int32_t *launch_rc;
+
+    /*!
+     * \brief Number of observations.
+     *
+     * Number of observations up to the new tick.
+     */
+    uint32_t n_observations;
+
+    /*!
+     * \brief Observations.
+     *
+     * Observations in the order they were returned by grvx_observe_or_tick().
+     */
+    const struct GrvxMissileObservation *observations;
+};
+
+/*!
+ * \brief Creates a new game host.
+ *
+ * A game host owns any number of games and advances all of them by one tick
+ * per round (see grvx_run_host_round()). The games of a round are distributed
+ * over the threads of \p pool.
+ *
+ * The host is driven by a single control thread, i.e., its functions must not
+ * be called concurrently. The caller owns the host and it is his/her
+ * obligation to eventually destroy it via grvx_delete_game_host(). The pool
+ * has to outlive the host.
+ *
+ * @param pool The pool handle.
+ * @return Game host handle.
+ */
+GRVX_EXPORT GrvxGameHostHandle grvx_new_game_host(GrvxPoolHandle pool);
+
+/*!
+ * \brief Deletes a game host.
+ *
+ * Deletes the host and all games it still owns. The planets of the games are
+ * not deleted.
+ *
+ * @param host The game host handle.
+ */
+GRVX_EXPORT void grvx_delete_game_host(GrvxGameHostHandle host);
+
+/*!
+ * \brief Hands a game over to a host.
+ *
+ * The host takes ownership of the game until it is returned via
+ * grvx_unhost_game(). Slots of games that were returned are reused.
+ *
+ * @param host The game host handle.
+ * @param game The game handle.
+ * @return Index of the game within the host.
+ */
+GRVX_EXPORT uint32_t grvx_host_game(GrvxGameHostHandle host,
+                                    GrvxGameHandle game);
+
+/*!
+ * \brief Returns a game from a host to the caller.
+ *
+ * The caller owns the returned game again and queued launches are discarded.
+ *
+ * @param host The game host handle.
+ * @param index Index of the game, see grvx_host_game().
+ * @return Game handle or ``NULL`` if there is no game at \p index.
+ */
+GRVX_EXPORT GrvxGameHandle grvx_unhost_game(GrvxGameHostHandle host,
+                                            uint32_t index);
+
+/*!
+ * \brief Looks up a hosted game.
+ *
+ * The game remains owned by the host and must not be advanced by the caller,
+ * but it can be inspected between rounds, e.g., by grvx_save_game().
+ *
+ * @param host The game host handle.
+ * @param index Index of the game, see grvx_host_game().
+ * @return Game handle or ``NULL`` if there is no game at \p index.
+ */
+GRVX_EXPORT GrvxGameHandle grvx_hosted_game(GrvxGameHostHandle host,
+                                            uint32_t index);
+
+/*!
+ * \brief Queues a missile launch for the next round.
+ *
+ * The request is passed to grvx_request_launch() at the beginning of the next
+ * round. Its result is reported by GrvxHostOutput::launch_rc.
+ *
+ * @param host The game host handle.
+ * @param index Index of the game, see grvx_host_game().
+ * @param planet_id ID of the planet.
+ * @param missile Settings of the requested missile launch.
+ * @param dt Step size of the simulation; see grvx_request_launch().
+ * @return Zero on success and non-zero if there is no game at \p index.
+ */
+GRVX_EXPORT int32_t
+grvx_host_request_launch(GrvxGameHostHandle host,
+                         uint32_t index,
+                         uint32_t planet_id,
+                         const struct GrvxMissileLaunch *missile,
+                         double dt);
+
+/*!
+ * \brief Advances all hosted games by one tick.
+ *
+ * Each game is processed by one of the threads of the pool: The queued
+ * launches are requested and grvx_observe_or_tick() is called until the tick
+ * advances. The launch results and the observations are written to the output
+ * of the game (see grvx_host_output()). Since games are independent, the
+ * results are identical to driving each game on its own.
+ *
+ * @param host The game host handle.
+ */
+GRVX_EXPORT void grvx_run_host_round(GrvxGameHostHandle host);
+
+/*!
+ * \brief Results of a hosted game in the last round.
+ *
+ * @param host The game host handle.
+ * @param index Index of the game, see grvx_host_game().
+ * @return Output of the game, which is valid until the next round, or ``NULL``
+ * if there is no game at \p index.
+ */
+GRVX_EXPORT const struct GrvxHostOutput *
+grvx_host_output(GrvxGameHostHandle host, uint32_t index);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
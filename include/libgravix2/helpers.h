@@ -20,6 +20,33 @@ extern "C" {
  */
 double grvx_sinc(double);
 
+/*!
+ * \brief Interpolates between two states on the unit sphere.
+ *
+ * The position is interpolated by a cubic Hermite spline in
+ * \f$\mathbb{R}^3\f$ through \p x0 and \p x1 with tangents \p v0 and \p v1
+ * and projected back onto the unit sphere. The velocity is the time
+ * derivative of the projected curve and thus tangential to the sphere.
+ *
+ * @param x0 Position at the beginning of the interval.
+ * @param v0 Velocity at the beginning of the interval.
+ * @param x1 Position at the end of the interval.
+ * @param v1 Velocity at the end of the interval.
+ * @param dt Length of the time interval.
+ * @param s Interpolation parameter, where 0 and 1 refer to the beginning and
+ * the end of the interval, respectively.
+ * @param x Interpolated position.
+ * @param v Interpolated velocity.
+ */
+void grvx_interpolate_on_sphere(const double *x0,
+                                const double *v0,
+                                const double *x1,
+                                const double *v1,
+                                double dt,
+                                double s,
+                                double *x,
+                                double *v);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
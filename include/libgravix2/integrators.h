@@ -21,6 +21,23 @@ struct GrvxQP {
     struct GrvxVec3D p; /*!< Vector of conjugate momenta. */
 };
 
+/*!
+ * \brief Phase space representation of GRVX_SIMD_LANES states in SoA layout.
+ */
+struct GrvxQPLanes {
+    struct GrvxVec3DLanes q; /*!< Vectors of canonical coordinates. */
+    struct GrvxVec3DLanes p; /*!< Vectors of conjugate momenta. */
+};
+
+/*!
+ * \brief Phase space representation of GRVX_SIMD_LANES_F32 states in single
+ * precision.
+ */
+struct GrvxQPLanesF32 {
+    struct GrvxVec3DLanesF32 q; /*!< Vectors of canonical coordinates. */
+    struct GrvxVec3DLanesF32 p; /*!< Vectors of conjugate momenta. */
+};
+
 /*!
  * \brief Single integration step.
  *
@@ -28,15 +45,23 @@ struct GrvxQP {
  * are compensated by tracking them in \p e. Initialize \p e with zeros for the
  * first iteration.
  *
+ * The planet sweep that evaluates the force of the last stage also yields the
+ * distance to the closest planet, which bounds the distance after the final
+ * drift. The distances are only recomputed at the updated position if this
+ * bound does not rule out a close encounter.
+ *
  * @param qp Phase space.
  * @param e Accumulation error.
  * @param h Step size.
  * @param planets Planets handle.
+ * @return Cosine of smallest angle between any planet and the updated
+ * position if the angle is smaller than GrvxConfig.min_dist. Otherwise, any
+ * value below the cosine of GrvxConfig.min_dist.
  */
-void grvx_integration_step(struct GrvxQP *qp,
-                           struct GrvxQP *e,
-                           double h,
-                           const struct GrvxPlanets *planets);
+double grvx_integration_step(struct GrvxQP *qp,
+                             struct GrvxQP *e,
+                             double h,
+                             const struct GrvxPlanets *planets);
 
 /*!
  * \brief Multiple integration steps.
@@ -57,6 +82,72 @@ unsigned grvx_integration_loop(struct GrvxQP *qp,
                                unsigned n,
                                const struct GrvxPlanets *planets);
 
+/*!
+ * \brief Integration with adaptive step sizes.
+ *
+ * \p qp is advanced by the integrator for a time span of \p t using step
+ * sizes \f$h_n = \epsilon / \rho_{n+1/2}\f$, where the control variable
+ * \f$\rho\f$ tracks the inverse of grvx_step_control() in a time-reversible
+ * way. Steps hence shrink during close encounters with planets and approach
+ * \p eps far from them. The propagation is stopped prematurely if the distance
+ * to a planet becomes too small. (The threshold is controlled via
+ * GrvxConfig.min_dist.)
+ *
+ * @param qp Phase space.
+ * @param rho Control variable that is carried over between consecutive calls.
+ * Non-positive values are replaced by an initial estimate.
+ * @param t Time span.
+ * @param eps Nominal step size, i.e., the step size far from planets.
+ * @param planets Planets handle.
+ * @return Remaining time span. (Positive if integration was stopped
+ *         prematurely.)
+ */
+double grvx_adaptive_integration_loop(struct GrvxQP *qp,
+                                      double *rho,
+                                      double t,
+                                      double eps,
+                                      const struct GrvxPlanets *planets);
+
+/*!
+ * \brief Single integration step for GRVX_SIMD_LANES states.
+ *
+ * Same as grvx_integration_step() but advances all lanes of \p qp at once.
+ * Each lane is processed with the same sequence of floating point operations
+ * as in grvx_integration_step().
+ *
+ * @param qp Phase spaces.
+ * @param e Accumulation errors.
+ * @param h Step size.
+ * @param planets Planets handle.
+ * @param mdist Proximity of the step of each lane, cf.
+ * grvx_integration_step().
+ */
+void grvx_integration_step_lanes(struct GrvxQPLanes *qp,
+                                 struct GrvxQPLanes *e,
+                                 double h,
+                                 const struct GrvxPlanets *planets,
+                                 double *mdist);
+
+/*!
+ * \brief Single integration step for GRVX_SIMD_LANES_F32 states in single
+ * precision.
+ *
+ * Same as grvx_integration_step_lanes() but all operations are carried out in
+ * single precision, including the compensated summation via \p e.
+ *
+ * @param qp Phase spaces.
+ * @param e Accumulation errors.
+ * @param h Step size.
+ * @param planets Planets handle.
+ * @param mdist Proximity of the step of each lane, cf.
+ * grvx_integration_step().
+ */
+void grvx_integration_step_lanes_f32(struct GrvxQPLanesF32 *qp,
+                                     struct GrvxQPLanesF32 *e,
+                                     float h,
+                                     const struct GrvxPlanets *planets,
+                                     float *mdist);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,103 @@
+/*!
+ * \file integrators_lanes.h
+ * \brief Kick and composition step of the lane kernels of the integrator.
+ *
+ * The double and single precision tiers only differ in the floating point
+ * type. This file is included by integrators.c once per tier with the
+ * following macros defined, which are undefined at the end of the file:
+ *  - SUFFIX: suffix of the names of the tier, e.g., empty or _f32
+ *  - REAL: floating point type
+ *  - N_LANES: number of lanes
+ *  - QP_LANES: phase space of the lanes, e.g., GrvxQPLanes
+ *  - VEC_LANES: vectors of the lanes, e.g., GrvxVec3DLanes
+ *
+ * For REAL = double, each lane is processed with the same sequence of
+ * floating point operations as in strang2() and grvx_integration_step().
+ */
+
+// no include guard, included once per tier
+
+#define LANES_CONCAT_(name, suffix) name##suffix
+#define LANES_CONCAT(name, suffix) LANES_CONCAT_(name, suffix)
+
+#define grvx_gradV_min_dist_lanes                                              \
+    LANES_CONCAT(grvx_gradV_min_dist_lanes, SUFFIX)
+#define grvx_integration_step_lanes                                            \
+    LANES_CONCAT(grvx_integration_step_lanes, SUFFIX)
+#define strang1_lanes LANES_CONCAT(strang1_lanes, SUFFIX)
+#define strang2_lanes LANES_CONCAT(strang2_lanes, SUFFIX)
+
+static void strang2_lanes(struct QP_LANES *qp,
+                          struct QP_LANES *e,
+                          REAL h,
+                          const struct GrvxPlanets *planets,
+                          REAL *mdist)
+{
+    struct VEC_LANES v = qp->q;
+    grvx_gradV_min_dist_lanes(&v, planets, mdist);
+
+    for (unsigned l = 0; l < N_LANES; l++) {
+        const REAL qx = qp->q.x[l];
+        const REAL qy = qp->q.y[l];
+        const REAL qz = qp->q.z[l];
+        const REAL px = qp->p.x[l];
+        const REAL py = qp->p.y[l];
+        const REAL pz = qp->p.z[l];
+
+        const REAL q_dot_gradV = qx * v.x[l] + qy * v.y[l] + qz * v.z[l];
+
+        e->p.x[l] += (q_dot_gradV * qx - v.x[l]) * h;
+        e->p.y[l] += (q_dot_gradV * qy - v.y[l]) * h;
+        e->p.z[l] += (q_dot_gradV * qz - v.z[l]) * h;
+
+        qp->p.x[l] = px + e->p.x[l];
+        qp->p.y[l] = py + e->p.y[l];
+        qp->p.z[l] = pz + e->p.z[l];
+
+        e->p.x[l] += px - qp->p.x[l];
+        e->p.y[l] += py - qp->p.y[l];
+        e->p.z[l] += pz - qp->p.z[l];
+    }
+}
+
+void grvx_integration_step_lanes(struct QP_LANES *qp,
+                                 struct QP_LANES *e,
+                                 REAL h,
+                                 const struct GrvxPlanets *planets,
+                                 REAL *mdist)
+{
+    GRVX_STATS_ADD(STEPS, N_LANES);
+
+    strang1_lanes(qp, e, (REAL)GAMMA[0] * h / (REAL)2.);
+    for (unsigned i = 0; i < GRVX_COMPOSITION_STAGES; i++) {
+        const double g2 = GAMMA[i];
+        const double g1 =
+            g2 + (i + 1 < GRVX_COMPOSITION_STAGES ? GAMMA[i + 1] : 0.);
+
+        strang2_lanes(qp, e, (REAL)g2 * h, planets, mdist);
+        strang1_lanes(qp, e, (REAL)g1 * h / (REAL)2.);
+    }
+
+    // see grvx_integration_step()
+    for (unsigned l = 0; l < N_LANES; l++) {
+        const REAL p2 = qp->p.x[l] * qp->p.x[l] + qp->p.y[l] * qp->p.y[l] +
+                        qp->p.z[l] * qp->p.z[l];
+        if (may_be_close(mdist[l], p2, h)) {
+            const struct GrvxVec3D q = {qp->q.x[l], qp->q.y[l], qp->q.z[l]};
+            mdist[l] = (REAL)grvx_min_dist(&q, planets);
+        }
+    }
+}
+
+#undef strang2_lanes
+#undef strang1_lanes
+#undef grvx_integration_step_lanes
+#undef grvx_gradV_min_dist_lanes
+#undef LANES_CONCAT
+#undef LANES_CONCAT_
+
+#undef VEC_LANES
+#undef QP_LANES
+#undef N_LANES
+#undef REAL
+#undef SUFFIX
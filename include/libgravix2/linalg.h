@@ -9,6 +9,8 @@
 extern "C" {
 #endif
 
+#include "libgravix2/config.h"
+
 /*!
  * \brief 3D vector in cartesian representation.
  */
@@ -16,6 +18,29 @@ struct GrvxVec3D {
     double x, y, z;
 };
 
+/*!
+ * \brief Bundle of GRVX_SIMD_LANES 3D vectors in cartesian representation.
+ *
+ * Each component is stored in a separate array (SoA layout) s.t. operations on
+ * all lanes can be mapped onto single SIMD instructions.
+ */
+struct GrvxVec3DLanes {
+    double x[GRVX_SIMD_LANES]; /*!< First components. */
+    double y[GRVX_SIMD_LANES]; /*!< Second components. */
+    double z[GRVX_SIMD_LANES]; /*!< Third components. */
+};
+
+/*!
+ * \brief Bundle of GRVX_SIMD_LANES_F32 3D vectors in single precision.
+ *
+ * Same as GrvxVec3DLanes but twice as many lanes fit into a SIMD register.
+ */
+struct GrvxVec3DLanesF32 {
+    float x[GRVX_SIMD_LANES_F32]; /*!< First components. */
+    float y[GRVX_SIMD_LANES_F32]; /*!< Second components. */
+    float z[GRVX_SIMD_LANES_F32]; /*!< Third components. */
+};
+
 /*!
  * \brief Dot product of \p a and \p b.
  *
@@ -0,0 +1,246 @@
+/*!
+ * \file missile_lanes.h
+ * \brief Missiles that are propagated in lockstep by the lane kernels of the
+ * integrator.
+ *
+ * The double and single precision tiers only differ in the floating point
+ * type and in whether the rounding error of the lanes is carried over at
+ * stored samples, cf. store_lane(). This file is included by missile.c once
+ * per tier with the following macros defined, which are undefined at the end
+ * of the file:
+ *  - SUFFIX: suffix of the names of the tier, e.g., empty or _f32
+ *  - REAL: floating point type
+ *  - N_LANES: number of lanes
+ *  - QP_LANES: phase space of the lanes, e.g., GrvxQPLanes
+ *  - CARRY_ERROR: whether the rounding error is carried over
+ */
+
+// no include guard, included once per tier
+
+#define LANES_CONCAT_(name, suffix) name##suffix
+#define LANES_CONCAT(name, suffix) LANES_CONCAT_(name, suffix)
+
+#define Lanes LANES_CONCAT(Lanes, SUFFIX)
+#define clear_lane_error LANES_CONCAT(clear_lane_error, SUFFIX)
+#define set_lane LANES_CONCAT(set_lane, SUFFIX)
+#define load_lane LANES_CONCAT(load_lane, SUFFIX)
+#define park_lane LANES_CONCAT(park_lane, SUFFIX)
+#define store_lane LANES_CONCAT(store_lane, SUFFIX)
+#define propagate_lanes LANES_CONCAT(propagate_lanes, SUFFIX)
+#define grvx_integration_step_lanes                                            \
+    LANES_CONCAT(grvx_integration_step_lanes, SUFFIX)
+
+struct Lanes {
+    struct QP_LANES qp;
+    struct QP_LANES e;
+    uint32_t missile[N_LANES];
+    unsigned sample[N_LANES];
+    unsigned step[N_LANES];
+    bool active[N_LANES];
+};
+
+static void clear_lane_error(struct Lanes *lanes, unsigned l)
+{
+    lanes->e.q.x[l] = 0.;
+    lanes->e.q.y[l] = 0.;
+    lanes->e.q.z[l] = 0.;
+    lanes->e.p.x[l] = 0.;
+    lanes->e.p.y[l] = 0.;
+    lanes->e.p.z[l] = 0.;
+}
+
+static void set_lane(struct Lanes *lanes, unsigned l, const struct GrvxQP *qp)
+{
+    lanes->qp.q.x[l] = (REAL)qp->q.x;
+    lanes->qp.q.y[l] = (REAL)qp->q.y;
+    lanes->qp.q.z[l] = (REAL)qp->q.z;
+    lanes->qp.p.x[l] = (REAL)qp->p.x;
+    lanes->qp.p.y[l] = (REAL)qp->p.y;
+    lanes->qp.p.z[l] = (REAL)qp->p.z;
+}
+
+static void load_lane(struct Lanes *lanes,
+                      unsigned l,
+                      const struct GrvxTrajectory *trj,
+                      uint32_t missile)
+{
+    const struct GrvxQP qp = {
+        .q.x = trj->x[GRVX_TRAJECTORY_SIZE - 1][0],
+        .q.y = trj->x[GRVX_TRAJECTORY_SIZE - 1][1],
+        .q.z = trj->x[GRVX_TRAJECTORY_SIZE - 1][2],
+        .p.x = trj->v[GRVX_TRAJECTORY_SIZE - 1][0],
+        .p.y = trj->v[GRVX_TRAJECTORY_SIZE - 1][1],
+        .p.z = trj->v[GRVX_TRAJECTORY_SIZE - 1][2],
+    };
+    set_lane(lanes, l, &qp);
+
+    clear_lane_error(lanes, l);
+    lanes->missile[l] = missile;
+    lanes->sample[l] = 0;
+    lanes->step[l] = 0;
+    lanes->active[l] = true;
+}
+
+static void park_lane(struct Lanes *lanes, unsigned l)
+{
+    lanes->active[l] = false;
+
+    // idle lanes are kept busy with a copy of an active lane s.t. they
+    // never run into singularities of the force field
+    for (unsigned k = 0; k < N_LANES; k++) {
+        if (lanes->active[k]) {
+            lanes->qp.q.x[l] = lanes->qp.q.x[k];
+            lanes->qp.q.y[l] = lanes->qp.q.y[k];
+            lanes->qp.q.z[l] = lanes->qp.q.z[k];
+            lanes->qp.p.x[l] = lanes->qp.p.x[k];
+            lanes->qp.p.y[l] = lanes->qp.p.y[k];
+            lanes->qp.p.z[l] = lanes->qp.p.z[k];
+            clear_lane_error(lanes, l);
+            return;
+        }
+    }
+}
+
+static void store_lane(struct Lanes *lanes,
+                       unsigned l,
+                       struct GrvxTrajectory *trj)
+{
+    struct GrvxQP qp = {
+        .q.x = lanes->qp.q.x[l],
+        .q.y = lanes->qp.q.y[l],
+        .q.z = lanes->qp.q.z[l],
+        .p.x = lanes->qp.p.x[l],
+        .p.y = lanes->qp.p.y[l],
+        .p.z = lanes->qp.p.z[l],
+    };
+    if (CARRY_ERROR) {
+        qp.q.x += lanes->e.q.x[l];
+        qp.q.y += lanes->e.q.y[l];
+        qp.q.z += lanes->e.q.z[l];
+        qp.p.x += lanes->e.p.x[l];
+        qp.p.y += lanes->e.p.y[l];
+        qp.p.z += lanes->e.p.z[l];
+    }
+
+    // same normalization as at the end of grvx_integration_loop(), which
+    // is carried out in double precision for both tiers
+    const double q_norm = 1. / grvx_mag(qp.q);
+    qp.q.x *= q_norm;
+    qp.q.y *= q_norm;
+    qp.q.z *= q_norm;
+
+    const double error = grvx_dot(qp.q, qp.p);
+    qp.p.x -= error * qp.q.x;
+    qp.p.y -= error * qp.q.y;
+    qp.p.z -= error * qp.q.z;
+
+    assert(fabs(grvx_dot(qp.q, qp.q) - 1.) < 1e-10);
+    assert(fabs(grvx_dot(qp.p, qp.q)) < 1e-10);
+
+    const unsigned i = lanes->sample[l];
+    trj->x[i][0] = qp.q.x;
+    trj->x[i][1] = qp.q.y;
+    trj->x[i][2] = qp.q.z;
+    trj->v[i][0] = qp.p.x;
+    trj->v[i][1] = qp.p.y;
+    trj->v[i][2] = qp.p.z;
+
+    set_lane(lanes, l, &qp);
+    if (CARRY_ERROR) {
+        lanes->e.q.x[l] = (REAL)(qp.q.x - lanes->qp.q.x[l]);
+        lanes->e.q.y[l] = (REAL)(qp.q.y - lanes->qp.q.y[l]);
+        lanes->e.q.z[l] = (REAL)(qp.q.z - lanes->qp.q.z[l]);
+        lanes->e.p.x[l] = (REAL)(qp.p.x - lanes->qp.p.x[l]);
+        lanes->e.p.y[l] = (REAL)(qp.p.y - lanes->qp.p.y[l]);
+        lanes->e.p.z[l] = (REAL)(qp.p.z - lanes->qp.p.z[l]);
+    } else {
+        clear_lane_error(lanes, l);
+    }
+}
+
+static void propagate_lanes(GrvxTrajectoryBatch batch,
+                            uint32_t n,
+                            GrvxPlanetsHandle planets,
+                            REAL h,
+                            uint32_t *n_steps,
+                            int32_t *premature)
+{
+    if (n == 0) {
+        return;
+    }
+
+    const REAL threshold = (REAL)cos(GRVX_MIN_DIST);
+
+    struct Lanes lanes;
+    uint32_t next = 0;
+    unsigned n_active = 0;
+    for (unsigned l = 0; l < N_LANES; l++) {
+        if (next < n) {
+            load_lane(&lanes, l, batch + next, next);
+            next++;
+            n_active++;
+        } else {
+            park_lane(&lanes, l);
+        }
+    }
+
+    while (n_active > 0) {
+        REAL mdist[N_LANES];
+        grvx_integration_step_lanes(&lanes.qp, &lanes.e, h, planets, mdist);
+
+        for (unsigned l = 0; l < N_LANES; l++) {
+            if (!lanes.active[l]) {
+                continue;
+            }
+
+            assert(fabs(mdist[l]) <= 1);
+
+            // mimics the loop conditions of grvx_integration_loop() and
+            // grvx_propagate_missile()
+            lanes.step[l] += 1;
+            const bool hit = mdist[l] >= threshold;
+            if (!hit && lanes.step[l] < GRVX_INT_STEPS) {
+                continue;
+            }
+
+            const uint32_t m = lanes.missile[l];
+            store_lane(&lanes, l, batch + m);
+            lanes.sample[l] += 1;
+
+            const bool stop = hit && lanes.step[l] < GRVX_INT_STEPS;
+            lanes.step[l] = 0;
+            if (!stop && lanes.sample[l] < GRVX_TRAJECTORY_SIZE) {
+                continue;
+            }
+
+            n_steps[m] = lanes.sample[l];
+            premature[m] = stop;
+            GRVX_STATS_ADD(PREMATURE, stop);
+
+            if (next < n) {
+                load_lane(&lanes, l, batch + next, next);
+                next++;
+            } else {
+                n_active--;
+                park_lane(&lanes, l);
+            }
+        }
+    }
+}
+
+#undef grvx_integration_step_lanes
+#undef propagate_lanes
+#undef store_lane
+#undef park_lane
+#undef load_lane
+#undef set_lane
+#undef clear_lane_error
+#undef Lanes
+#undef LANES_CONCAT
+#undef LANES_CONCAT_
+
+#undef CARRY_ERROR
+#undef QP_LANES
+#undef N_LANES
+#undef REAL
+#undef SUFFIX
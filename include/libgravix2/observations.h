@@ -1,18 +1,42 @@
 #pragma once
 
 #include "libgravix2/game.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Binary min-heap of observations ordered by time. Observations of equal time
+ * are popped in order of insertion. Observations are stored by value in a
+ * single array, which only grows (by doubling) if the heap is full, i.e., no
+ * memory is allocated once the number of pending observations has settled.
+ * Heaps in external storage never grow and must not be overfilled.
+ */
+struct GrvxQueuedObservation {
+    struct GrvxMissileObservation obs;
+    uint64_t seq;
+};
 
 struct GrvxMissileObservations {
-    struct GrvxMissileObservation *obs;
-    struct GrvxMissileObservations *next;
+    struct GrvxQueuedObservation *heap;
+    unsigned size;
+    unsigned capacity;
+    uint64_t seq;
+    bool external;
 };
 
-struct GrvxMissileObservations *
-add_observation(struct GrvxMissileObservations *,
-                struct GrvxMissileObservation *);
+void init_observations(struct GrvxMissileObservations *, unsigned capacity);
+
+void init_observations_in(struct GrvxMissileObservations *,
+                          struct GrvxQueuedObservation *heap,
+                          unsigned capacity);
+
+void add_observation(struct GrvxMissileObservations *,
+                     const struct GrvxMissileObservation *);
+
+const struct GrvxMissileObservation *
+peek_observation(const struct GrvxMissileObservations *);
 
-struct GrvxMissileObservations *
-pop_observation(struct GrvxMissileObservations *,
-                struct GrvxMissileObservation **);
+int pop_observation(struct GrvxMissileObservations *,
+                    struct GrvxMissileObservation *);
 
 void delete_observations(struct GrvxMissileObservations *);
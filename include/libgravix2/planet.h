@@ -9,19 +9,133 @@
 extern "C" {
 #endif
 
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "libgravix2/config.h"
+#include "libgravix2/field.h"
+#include "libgravix2/spatial.h"
+#include "libgravix2/tree.h"
+
+/*!
+ * \brief Alignment of the coordinate arrays of GrvxPlanets in bytes.
+ */
+#define GRVX_PLANETS_ALIGNMENT 64
+
+/*!
+ * \brief Granularity of the padding of the coordinate arrays of GrvxPlanets.
+ *
+ * The number of elements of each array is rounded up to a multiple of this
+ * value, which itself is a multiple of GRVX_SIMD_LANES and spans a multiple of
+ * GRVX_PLANETS_ALIGNMENT bytes.
+ */
+#define GRVX_PLANETS_PADDING (GRVX_PLANETS_ALIGNMENT / sizeof(double))
+
+/*!
+ * \brief Smallest number of planets for which proximity queries are answered
+ * by the spatial index GrvxPlanetsIndex rather than by a linear scan.
+ */
+#define GRVX_PLANETS_INDEX_THRESHOLD 64
+
+/*!
+ * \brief Lazily built acceleration structures of GrvxPlanets.
+ *
+ * The structures are invalidated whenever planets are moved or removed and
+ * rebuilt upon the next query. Since queries operate on constant sets of
+ * planets, the structures are referred to by pointer. Rebuilds are guarded by
+ * a mutex and published via the atomic validity flags, s.t. concurrent queries
+ * on up-to-date structures do not contend for the mutex.
+ */
+struct GrvxPlanetsIndex {
+    struct GrvxSpatialIndex idx; /*!< Spatial index. */
+    struct GrvxTree tree;        /*!< Tree of the force engine. */
+    struct GrvxField field;      /*!< Baked field of the force engine. */
+    double theta;                /*!< Tree opening angle (0 if unused). */
+    unsigned field_n;            /*!< Resolution of the field (0 if unused). */
+    double field_r;              /*!< Radius of the near field. */
+    bool built;                  /*!< Set if the spatial index is allocated. */
+    bool tree_built;             /*!< Set if the tree is allocated. */
+    bool field_built;            /*!< Set if the field is allocated. */
+    _Atomic bool valid;          /*!< Set if the spatial index is up to date. */
+    _Atomic bool tree_valid;     /*!< Set if the tree is up to date. */
+    _Atomic bool field_valid;    /*!< Set if the field is up to date. */
+    pthread_mutex_t mutex;       /*!< Guards rebuilds. */
+};
+
 /*!
  * \brief Set of planets.
  *
- * The spatial position of each planet is stored as a tuple of the cartesian
- * coordinates \f$(x_1, y_1, z_1, x_2, y_2, z_2, \ldots x_n, y_n, z_n)\f$ in
- * \ref GrvxPlanets.data, where \f$(x_i, y_i, z_i)\f$ refers to the \f$i\f$-th
- * planet.
+ * The spatial position of each planet is stored in cartesian coordinates in
+ * separate arrays (SoA layout), such that \f$(x_i, y_i, z_i)\f$ =
+ * (GrvxPlanets.x[i], GrvxPlanets.y[i], GrvxPlanets.z[i]) refers to the
+ * \f$i\f$-th planet. The arrays are aligned to GRVX_PLANETS_ALIGNMENT bytes and
+ * padded with zeros up to a multiple of GRVX_PLANETS_PADDING elements. Zero
+ * vectors do not contribute to the force field s.t. padding elements can be
+ * safely included in sweeps over all planets.
  */
 struct GrvxPlanets {
-    unsigned n;   /*!< Number of planets, \f$n\f$. */
-    double *data; /*!< Data array. */
+    unsigned n;                     /*!< Number of planets, \f$n\f$. */
+    double *x;                      /*!< First components. */
+    double *y;                      /*!< Second components. */
+    double *z;                      /*!< Third components. */
+    struct GrvxPlanetsIndex *index; /*!< Spatial index. */
 };
 
+/*!
+ * \brief Number of padded elements of the coordinate arrays of GrvxPlanets.
+ *
+ * @param n Number of planets.
+ * @return \p n rounded up to the next multiple of GRVX_PLANETS_PADDING.
+ */
+static inline unsigned grvx_planets_padded(unsigned n)
+{
+    const unsigned k = (unsigned)GRVX_PLANETS_PADDING;
+    return (n + k - 1) / k * k;
+}
+
+/*!
+ * \brief Nearest planet to a position.
+ *
+ * For at least GRVX_PLANETS_INDEX_THRESHOLD planets the query is answered by
+ * the spatial index, which is (re)built if necessary. Otherwise, all planets
+ * are scanned.
+ *
+ * @param planets The planets.
+ * @param q Cartesian coordinates of the position on the unit sphere.
+ * @param dot Set to the cosine of the angle between \p q and the nearest
+ * planet. Can be NULL.
+ * @return Index of the nearest planet or GRVX_SPATIAL_NONE if there are no
+ * planets.
+ */
+unsigned grvx_nearest_planet(const struct GrvxPlanets *planets,
+                             const double q[3],
+                             double *dot);
+
+/*!
+ * \brief Tree of the force engine.
+ *
+ * The tree is (re)built if necessary.
+ *
+ * @param planets The planets.
+ * @return The tree or NULL if forces are to be summed directly, cf.
+ * grvx_set_opening_angle().
+ */
+const struct GrvxTree *grvx_planets_tree(const struct GrvxPlanets *planets);
+
+/*!
+ * \brief Baked field of the force engine.
+ *
+ * The field is (re)built if necessary. If the force engine approximates far
+ * clusters of planets (cf. grvx_set_opening_angle()), the tree is used to
+ * sample the field.
+ *
+ * @param planets The planets.
+ * @return The field or NULL if forces are not interpolated, cf.
+ * grvx_bake_field().
+ */
+const struct GrvxField *grvx_planets_field(const struct GrvxPlanets *planets);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
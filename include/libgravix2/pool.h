@@ -0,0 +1,105 @@
+/*!
+ * \file pool.h
+ * \brief Thread pool with work stealing.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*!
+ * \brief Alignment of the per-worker queues of GrvxPool in bytes.
+ *
+ * Each queue occupies its own cache line to avoid false sharing between
+ * workers.
+ */
+#define GRVX_POOL_ALIGNMENT 64
+
+/*!
+ * \brief Task to be executed on a range of items.
+ *
+ * @param ctx Context as passed to grvx_pool_run().
+ * @param begin First item of the range.
+ * @param end One past the last item of the range.
+ */
+typedef void (*GrvxPoolTask)(void *ctx, uint32_t begin, uint32_t end);
+
+/*!
+ * \brief Queue of chunks owned by a single worker.
+ *
+ * The range of chunk indices \f$[\mathrm{lo}, \mathrm{hi})\f$ is packed into a
+ * single atomic word (``lo`` in the upper and ``hi`` in the lower 32 bits) such
+ * that the owner can pop from the front and other threads can steal from the
+ * back by compare-and-swap operations.
+ */
+struct GrvxPoolQueue {
+    _Alignas(GRVX_POOL_ALIGNMENT) _Atomic uint64_t range; /*!< Packed range. */
+};
+
+struct GrvxPool;
+
+/*!
+ * \brief Worker thread of GrvxPool.
+ */
+struct GrvxPoolWorker {
+    pthread_t thread;      /*!< Thread handle. */
+    struct GrvxPool *pool; /*!< The pool the worker belongs to. */
+    unsigned id;           /*!< Index of the worker and its queue. */
+};
+
+/*!
+ * \brief Pool of persistent worker threads.
+ *
+ * Workers are spawned once upon creation of the pool and sleep until the next
+ * job is posted by incrementing GrvxPool::generation. The calling thread of
+ * grvx_pool_run() merely waits for the workers to finish.
+ */
+struct GrvxPool {
+    unsigned n_threads;             /*!< Number of workers. */
+    struct GrvxPoolWorker *workers; /*!< Workers. */
+    struct GrvxPoolQueue *queues;   /*!< Per-worker queues. */
+    pthread_mutex_t run_mutex;      /*!< Serializes calls of grvx_pool_run(). */
+    pthread_mutex_t mutex;          /*!< Protects the fields below. */
+    pthread_cond_t wake;            /*!< Signals a new job or shutdown. */
+    pthread_cond_t done;            /*!< Signals that all workers are idle. */
+    uint64_t generation;            /*!< Counter of posted jobs. */
+    unsigned n_busy;                /*!< Workers busy with the current job. */
+    bool shutdown;                  /*!< Workers terminate if set. */
+    GrvxPoolTask task;              /*!< Task of the current job. */
+    void *ctx;                      /*!< Context of the current job. */
+    uint32_t n;                     /*!< Number of items of the current job. */
+    uint32_t chunk;                 /*!< Number of items per chunk. */
+};
+
+/*!
+ * \brief Executes a task on all items in parallel.
+ *
+ * The items \f$[0, n)\f$ are split into chunks of \p chunk items, which are
+ * evenly distributed over the queues of all workers. Workers that run out of
+ * chunks steal half of the remaining chunks of another worker. Returns after
+ * all chunks have been processed. Concurrent calls on the same pool are
+ * serialized.
+ *
+ * @param pool The pool.
+ * @param n Number of items.
+ * @param chunk Maximal number of items passed to a single invocation of \p
+ * task. Has to be positive.
+ * @param task The task.
+ * @param ctx Context passed to \p task.
+ */
+void grvx_pool_run(struct GrvxPool *pool,
+                   uint32_t n,
+                   uint32_t chunk,
+                   GrvxPoolTask task,
+                   void *ctx);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -10,7 +10,28 @@ extern "C" {
 #endif
 
 struct GrvxVec3D;
+struct GrvxVec3DLanes;
+struct GrvxVec3DLanesF32;
 struct GrvxPlanets;
+struct GrvxTree;
+struct GrvxField;
+
+/*!
+ * \brief Range of the step size control in units of GrvxConfig.min_dist.
+ *
+ * See grvx_step_control().
+ */
+#define GRVX_STEP_CONTROL_RANGE 10.
+
+/*!
+ * \brief Initializes the lookup table of the force.
+ *
+ * The force kernels do not check whether the table (cf. GRVX_POT_TABLE_SIZE)
+ * has been initialized. This is done once in grvx_new_planets() and has to be
+ * done explicitly by functions that evaluate the force without a planets
+ * handle. Subsequent calls are no-ops.
+ */
+void grvx_init_pot(void);
 
 /*!
  * \brief Gradient of the potential at position \p q.
@@ -34,6 +55,91 @@ void grvx_gradV(struct GrvxVec3D *q, const struct GrvxPlanets *planets);
 double grvx_min_dist(const struct GrvxVec3D *q,
                      const struct GrvxPlanets *planets);
 
+/*!
+ * \brief Gradient of the potential and minimal distance to any planet at
+ * position \p q.
+ *
+ * Fused version of grvx_gradV() and grvx_min_dist() that evaluates both in a
+ * single sweep over all planets. If the force engine approximates far clusters
+ * of planets (cf. grvx_set_opening_angle()) or interpolates a baked field (cf.
+ * grvx_bake_field()), not all planets are visited and the minimal distance is
+ * reported as zero, i.e., callers have to resort to grvx_min_dist().
+ *
+ * @param q The position where the gradient is evaluated. The result overwrites
+ * this variable.
+ * @param planets Planets that generate the force field.
+ * @return Cosine of smallest angle between \p q and any planet (or one).
+ */
+double grvx_gradV_min_dist(struct GrvxVec3D *q,
+                           const struct GrvxPlanets *planets);
+
+/*!
+ * \brief Gradient of the potential and minimal distance to any planet at
+ * GRVX_SIMD_LANES positions.
+ *
+ * Same as grvx_gradV_min_dist() but evaluated for all lanes of \p q at once.
+ *
+ * @param q The positions where the gradient is evaluated. The result
+ * overwrites this variable.
+ * @param planets Planets that generate the force field.
+ * @param mdist Cosine of smallest angle between each lane of \p q and any
+ * planet.
+ */
+void grvx_gradV_min_dist_lanes(struct GrvxVec3DLanes *q,
+                               const struct GrvxPlanets *planets,
+                               double *mdist);
+
+/*!
+ * \brief Gradient of the potential and minimal distance to any planet at
+ * GRVX_SIMD_LANES_F32 positions in single precision.
+ *
+ * Same as grvx_gradV_min_dist_lanes() but evaluated in single precision. (For
+ * \f$V_{3\mathrm{D}}\f$ the force kernel itself is evaluated in double
+ * precision.)
+ *
+ * @param q The positions where the gradient is evaluated. The result
+ * overwrites this variable.
+ * @param planets Planets that generate the force field.
+ * @param mdist Cosine of smallest angle between each lane of \p q and any
+ * planet.
+ */
+void grvx_gradV_min_dist_lanes_f32(struct GrvxVec3DLanesF32 *q,
+                                   const struct GrvxPlanets *planets,
+                                   float *mdist);
+
+/*!
+ * \brief Samples the far field of a baked field.
+ *
+ * @param field The field as initialized by grvx_field_init().
+ * @param planets Planets that generate the force field.
+ * @param tree Tree used to evaluate the force or NULL for direct summation.
+ */
+void grvx_sample_field(struct GrvxField *field,
+                       const struct GrvxPlanets *planets,
+                       const struct GrvxTree *tree);
+
+/*!
+ * \brief Step size control function for close encounters with planets.
+ *
+ * Evaluates \f$\sigma(q) = (1 + c (1 - q \cdot x)^{-1})^{-1/2}\f$, where
+ * \f$x\f$ is the position of the nearest planet (cf. grvx_nearest_planet())
+ * and \f$c\f$ is chosen s.t. \f$\sigma \approx 1\f$ far from planets and
+ * \f$\sigma\f$ decreases linearly with the distance to a planet once it gets
+ * smaller than GRVX_STEP_CONTROL_RANGE times GrvxConfig.min_dist. Step sizes
+ * proportional to \f$\sigma\f$ resolve close encounters without slowing down
+ * the rest of the flight, independent of the number of planets.
+ *
+ * @param q The position of the missile.
+ * @param p The velocity of the missile.
+ * @param planets Planets that generate the force field.
+ * @param dlog_sigma Time derivative of \f$\ln\sigma\f$ along \p p.
+ * @return \f$\sigma(q)\f$.
+ */
+double grvx_step_control(const struct GrvxVec3D *q,
+                         const struct GrvxVec3D *p,
+                         const struct GrvxPlanets *planets,
+                         double *dlog_sigma);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
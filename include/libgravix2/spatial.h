@@ -0,0 +1,120 @@
+/*!
+ * \file spatial.h
+ * \brief Spatial index of points on the unit sphere.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \brief Marks the end of a cell list of GrvxSpatialIndex.
+ */
+#define GRVX_SPATIAL_NONE ((unsigned)-1)
+
+/*!
+ * \brief Largest number of latitudinal rings of GrvxSpatialIndex.
+ */
+#define GRVX_SPATIAL_MAX_RINGS 2048
+
+/*!
+ * \brief Spatial index of points on the unit sphere.
+ *
+ * The sphere is divided into rings of constant latitude of equal height and
+ * each ring is further divided into cells of (approximately) the same width,
+ * s.t. all cells cover similar areas. Each cell holds a singly linked list of
+ * the points that fall into it, which allows for inserting points one by one.
+ *
+ * Queries are restricted to spherical caps: Only points in cells that overlap
+ * with the bounding box of the cap in latitude and longitude are visited.
+ */
+struct GrvxSpatialIndex {
+    unsigned n_rings;     /*!< Number of latitudinal rings. */
+    double ring_height;   /*!< Latitudinal height of each ring. */
+    unsigned *ring_start; /*!< First cell of each ring (+1 sentinel). */
+    unsigned *head;       /*!< First point of each cell. */
+    unsigned *next;       /*!< Next point in the same cell. */
+    double *x;            /*!< First components of the points. */
+    double *y;            /*!< Second components of the points. */
+    double *z;            /*!< Third components of the points. */
+    unsigned n;           /*!< Number of points. */
+    unsigned capacity;    /*!< Maximal number of points. */
+};
+
+/*!
+ * \brief Initializes an empty index.
+ *
+ * @param idx The index.
+ * @param capacity Maximal number of points.
+ * @param cell_size Targeted height and width of the cells in radians. The
+ * number of rings is limited by GRVX_SPATIAL_MAX_RINGS.
+ */
+void grvx_spatial_index_init(struct GrvxSpatialIndex *idx,
+                             unsigned capacity,
+                             double cell_size);
+
+/*!
+ * \brief Frees the memory of an index.
+ *
+ * @param idx The index.
+ */
+void grvx_spatial_index_free(struct GrvxSpatialIndex *idx);
+
+/*!
+ * \brief Inserts a point into the index.
+ *
+ * Points are referred to by consecutive IDs in order of insertion.
+ *
+ * @param idx The index. Must not be full.
+ * @param x Cartesian coordinates of a point on the unit sphere.
+ * @return ID of the inserted point.
+ */
+unsigned grvx_spatial_index_insert(struct GrvxSpatialIndex *idx,
+                                   const double x[3]);
+
+/*!
+ * \brief Largest dot product between a query point and any point within a
+ * spherical cap.
+ *
+ * All points with an angular distance to \p q of at most \p r are taken into
+ * account but (depending on the cell layout) some of the points further away
+ * might be visited as well. Hence, the result is exact if it is at least
+ * \f$\cos r\f$.
+ *
+ * @param idx The index.
+ * @param q Cartesian coordinates of the query point on the unit sphere.
+ * @param r Angular radius of the cap.
+ * @param id Set to the ID of the point with the largest dot product. Only
+ * written if any point was visited. Can be NULL.
+ * @return Largest dot product of all visited points or -2 if no point was
+ * visited.
+ */
+double grvx_spatial_index_max_dot(const struct GrvxSpatialIndex *idx,
+                                  const double q[3],
+                                  double r,
+                                  unsigned *id);
+
+/*!
+ * \brief Nearest point to a query point.
+ *
+ * Searches caps of growing radii starting at \p r until the nearest point is
+ * found.
+ *
+ * @param idx The index. Must not be empty.
+ * @param q Cartesian coordinates of the query point on the unit sphere.
+ * @param r Angular radius of the first cap, e.g., the typical distance between
+ * neighboring points.
+ * @param dot Set to the dot product between \p q and the nearest point. Can be
+ * NULL.
+ * @return ID of the nearest point.
+ */
+unsigned grvx_spatial_index_nearest(const struct GrvxSpatialIndex *idx,
+                                    const double q[3],
+                                    double r,
+                                    double *dot);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,112 @@
+/*!
+ * \file stats.h
+ * \brief Per-thread runtime statistics.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libgravix2/config.h"
+
+/*!
+ * \brief Alignment of GrvxStatsBlock in bytes.
+ *
+ * Each block occupies its own cache lines to avoid false sharing between
+ * threads.
+ */
+#define GRVX_STATS_ALIGNMENT 64
+
+/*!
+ * \brief Counters of GrvxStatsBlock, cf. GrvxStats.
+ */
+enum GrvxStat {
+    GRVX_STAT_STEPS,
+    GRVX_STAT_FORCE_EVALUATIONS,
+    GRVX_STAT_INTERACTIONS,
+    GRVX_STAT_PREMATURE,
+    GRVX_STAT_OBSERVATIONS_ADDED,
+    GRVX_STAT_OBSERVATIONS_POPPED,
+    GRVX_STAT_NS_PROPAGATE,
+    GRVX_STAT_NS_REQUEST_LAUNCH,
+    GRVX_STAT_COUNT
+};
+
+/*!
+ * \brief Counters of a single thread.
+ *
+ * Blocks are only written by their owning thread, which loads and stores the
+ * counters separately (i.e., w/o read-modify-write operations), and are read
+ * by grvx_get_stats() from any thread. Blocks of terminated threads keep their
+ * counts and are handed over to new threads.
+ */
+struct GrvxStatsBlock {
+    _Alignas(GRVX_STATS_ALIGNMENT)
+        _Atomic uint64_t counters[GRVX_STAT_COUNT]; /*!< The counters. */
+    struct GrvxStatsBlock *next; /*!< Next block of all threads. */
+    bool in_use;                 /*!< Set while owned by a thread. */
+};
+
+#if GRVX_STATS
+
+/*!
+ * \brief Block of the calling thread or NULL if not yet acquired.
+ */
+extern _Thread_local struct GrvxStatsBlock *grvx_stats_local;
+
+/*!
+ * \brief Assigns a block to the calling thread.
+ *
+ * @return The block of the calling thread.
+ */
+struct GrvxStatsBlock *grvx_stats_acquire(void);
+
+/*!
+ * \brief Monotonic clock.
+ *
+ * @return Time in nanoseconds.
+ */
+uint64_t grvx_stats_now(void);
+
+/*!
+ * \brief Adds to a counter of the calling thread.
+ *
+ * @param stat The counter.
+ * @param n The increment.
+ */
+static inline void grvx_stats_add(enum GrvxStat stat, uint64_t n)
+{
+    struct GrvxStatsBlock *block = grvx_stats_local;
+    if (block == NULL) {
+        block = grvx_stats_acquire();
+    }
+
+    _Atomic uint64_t *counter = &block->counters[stat];
+    const uint64_t value = atomic_load_explicit(counter, memory_order_relaxed);
+    atomic_store_explicit(counter, value + n, memory_order_relaxed);
+}
+
+#define GRVX_STATS_ADD(stat, n) grvx_stats_add(GRVX_STAT_##stat, (n))
+#define GRVX_STATS_TIMER(t0) const uint64_t t0 = grvx_stats_now()
+#define GRVX_STATS_ADD_TIME(stat, t0)                                         \
+    grvx_stats_add(GRVX_STAT_##stat, grvx_stats_now() - (t0))
+
+#else
+
+// the increment is referenced to not leave variables unused
+#define GRVX_STATS_ADD(stat, n) ((void)(n))
+#define GRVX_STATS_TIMER(t0) ((void)0)
+#define GRVX_STATS_ADD_TIME(stat, t0) ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,92 @@
+/*!
+ * \file tree.h
+ * \brief Hierarchical clustering of planets for far-field approximations.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \brief Largest number of planets in a leaf of GrvxTree.
+ */
+#define GRVX_TREE_LEAF_SIZE 8
+
+/*!
+ * \brief Number of pseudo-planets per node of GrvxTree.
+ */
+#define GRVX_TREE_PSEUDO 3
+
+/*!
+ * \brief Node of GrvxTree, i.e., a cluster of planets.
+ */
+struct GrvxTreeNode {
+    double c[3];                   /*!< Center of the cluster. */
+    double rho;                    /*!< Angular radius of the cluster. */
+    double cos_open;               /*!< Cosine of the opening distance. */
+    double x[GRVX_TREE_PSEUDO][3]; /*!< Positions of the pseudo-planets. */
+    double w[GRVX_TREE_PSEUDO];    /*!< Weights of the pseudo-planets. */
+    unsigned begin;                /*!< First planet of the cluster. */
+    unsigned end;                  /*!< One past the last planet. */
+    unsigned skip; /*!< Next node in pre-order that is not a descendant. */
+};
+
+/*!
+ * \brief Binary tree of clusters of planets (Barnes-Hut).
+ *
+ * Planets are split recursively at the median of the longest side of their
+ * bounding box until at most GRVX_TREE_LEAF_SIZE planets remain. The nodes are
+ * stored in pre-order s.t. the tree can be traversed without a stack: The
+ * first child of node \f$i\f$ (if any) is node \f$i + 1\f$ and
+ * GrvxTreeNode.skip jumps over all descendants. The planets are reordered
+ * accordingly, i.e., each node refers to a contiguous range of planets.
+ *
+ * Each cluster is contained in a spherical cap of angular radius \f$\rho\f$
+ * around its center GrvxTreeNode.c, which points along the sum of the
+ * positions of its planets. At angular distances \f$\delta > \rho / \theta\f$
+ * and \f$\delta > \rho + r_\mathrm{min}\f$ from the center, where \f$\theta\f$
+ * is the opening angle and \f$r_\mathrm{min}\f$ is GRVX_MIN_DIST, the
+ * contribution of the cluster is approximated by GRVX_TREE_PSEUDO weighted
+ * pseudo-planets. They reproduce the total weight, the center, and the second
+ * moments of the cluster in the tangent plane at the center, s.t. the relative
+ * error of the approximation is of order \f$\theta^3\f$. (Clusters of at most
+ * GRVX_TREE_PSEUDO planets are represented exactly.) The second condition
+ * ensures that planets within \f$r_\mathrm{min}\f$ are always visited.
+ */
+struct GrvxTree {
+    struct GrvxTreeNode *nodes; /*!< Nodes in pre-order. */
+    unsigned n_nodes;           /*!< Number of nodes. */
+    double *x;                  /*!< First components in tree order. */
+    double *y;                  /*!< Second components in tree order. */
+    double *z;                  /*!< Third components in tree order. */
+};
+
+/*!
+ * \brief Builds a tree.
+ *
+ * @param tree The tree.
+ * @param x First components of the positions of the planets.
+ * @param y Second components of the positions of the planets.
+ * @param z Third components of the positions of the planets.
+ * @param n Number of planets.
+ * @param theta Opening angle, \f$\theta > 0\f$.
+ */
+void grvx_tree_build(struct GrvxTree *tree,
+                     const double *x,
+                     const double *y,
+                     const double *z,
+                     unsigned n,
+                     double theta);
+
+/*!
+ * \brief Frees the memory of a tree.
+ *
+ * @param tree The tree.
+ */
+void grvx_tree_free(struct GrvxTree *tree);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,254 @@
+#include "libgravix2/field.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "libgravix2/constants.h"
+
+// widens all bins to guard against round-off errors of the bin assignment
+#define MARGIN 1e-9
+
+/*
+ * Point on face f at the coordinates (u, v), cf. grvx_field_locate().
+ */
+static void face_point(unsigned f, double u, double v, double q[3])
+{
+    const unsigned a = f / 2;
+    const unsigned b = a == 2 ? 0 : a + 1;
+    const unsigned c = a == 0 ? 2 : a - 1;
+
+    const double norm = 1. / sqrt(1. + u * u + v * v);
+    q[a] = (f % 2 == 0 ? 1. : -1.) * norm;
+    q[b] = u * norm;
+    q[c] = v * norm;
+}
+
+static double dot(const double a[3], const double b[3])
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/*
+ * A bin is a spherical quadrilateral bounded by great circles. Hence, the
+ * point of the bin furthest from its center is one of its corners and the bin
+ * is contained in the cap around the center that reaches the corners.
+ */
+static double bin_cap(unsigned f,
+                      unsigned i,
+                      unsigned j,
+                      unsigned n_bins,
+                      double center[3])
+{
+    const double h = 2. / n_bins;
+    const double u0 = -1. + i * h;
+    const double v0 = -1. + j * h;
+    face_point(f, u0 + .5 * h, v0 + .5 * h, center);
+
+    double min_dot = 1.;
+    for (unsigned k = 0; k < 4; k++) {
+        double corner[3];
+        face_point(f, u0 + (k / 2) * h, v0 + (k % 2) * h, corner);
+        const double d = dot(center, corner);
+        min_dot = d < min_dot ? d : min_dot;
+    }
+
+    return acos(min_dot > -1. ? min_dot : -1.);
+}
+
+static unsigned bin_index(double u, unsigned n_bins)
+{
+    const double g = (u + 1.) * .5 * n_bins;
+    const unsigned i = g > 0. ? (unsigned)g : 0;
+    return i < n_bins ? i : n_bins - 1;
+}
+
+/*
+ * Range of bins along one axis of a face that may intersect with a cap. The
+ * coordinate u = q[b] / q[a] of the face is constant along great circles
+ * through the remaining axis and such a great circle intersects with the cap
+ * of angular radius r around p iff |p[b] - u p[a]| <= sin(r) sqrt(1 + u^2).
+ */
+static bool cap_range(double p_a,
+                      double p_b,
+                      double sin_r,
+                      unsigned n_bins,
+                      unsigned *lo,
+                      unsigned *hi)
+{
+    double u_lo = -1.;
+    double u_hi = 1.;
+
+    // otherwise, the cap contains the remaining axis and thus all u
+    const double a = p_a * p_a - sin_r * sin_r;
+    if (a > 0.) {
+        const double w = sin_r * sqrt(p_a * p_a + p_b * p_b - sin_r * sin_r);
+        u_lo = (p_a * p_b - w) / a;
+        u_hi = (p_a * p_b + w) / a;
+    }
+
+    if (u_hi < -1. || u_lo > 1.) {
+        return false;
+    }
+
+    *lo = bin_index(u_lo, n_bins);
+    *hi = bin_index(u_hi, n_bins);
+    return true;
+}
+
+/*
+ * Collects all bins that intersect with the cap of radius r_near around p.
+ * Only the bins within the ranges of cap_range() are tested.
+ */
+static unsigned planet_bins(const struct GrvxField *field,
+                            const double *centers,
+                            const double *cos_reach,
+                            const double p[3],
+                            unsigned *bins)
+{
+    const unsigned nb = field->n_bins;
+    const double r = field->r_near + MARGIN;
+    const double sin_r = r < M_PI / 2. ? sin(r) : 1.;
+
+    unsigned count = 0;
+    for (unsigned f = 0; f < 6; f++) {
+        const unsigned a = f / 2;
+        const unsigned b = a == 2 ? 0 : a + 1;
+        const unsigned c = a == 0 ? 2 : a - 1;
+        const double p_a = (f % 2 == 0 ? 1. : -1.) * p[a];
+
+        // the cap does not reach the hemisphere of the face
+        if (r < M_PI / 2. && p_a <= -sin_r) {
+            continue;
+        }
+
+        unsigned i_lo, i_hi, j_lo, j_hi;
+        if (!cap_range(p_a, p[b], sin_r, nb, &i_lo, &i_hi) ||
+            !cap_range(p_a, p[c], sin_r, nb, &j_lo, &j_hi)) {
+            continue;
+        }
+
+        for (unsigned i = i_lo; i <= i_hi; i++) {
+            for (unsigned j = j_lo; j <= j_hi; j++) {
+                const unsigned k = (f * nb + i) * nb + j;
+                if (dot(&centers[3 * k], p) >= cos_reach[k]) {
+                    bins[count++] = k;
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+/*
+ * Assigns each planet to all bins that intersect with the cap of radius
+ * r_near around it. The bins are stored as contiguous ranges (CSR layout) and
+ * hence the planets are counted in a first pass and copied in a second one.
+ */
+static void bin_planets(struct GrvxField *field,
+                        const double *x,
+                        const double *y,
+                        const double *z,
+                        unsigned n)
+{
+    const unsigned nb = field->n_bins;
+    const unsigned n_total = 6 * nb * nb;
+
+    double *centers = malloc(sizeof(double) * 3 * n_total);
+    double *cos_reach = malloc(sizeof(double) * n_total);
+    for (unsigned f = 0; f < 6; f++) {
+        for (unsigned i = 0; i < nb; i++) {
+            for (unsigned j = 0; j < nb; j++) {
+                const unsigned b = (f * nb + i) * nb + j;
+                const double rho = bin_cap(f, i, j, nb, &centers[3 * b]);
+                cos_reach[b] = cos(rho + field->r_near + MARGIN);
+            }
+        }
+    }
+
+    unsigned *bins = malloc(sizeof(unsigned) * n_total);
+    unsigned *next = malloc(sizeof(unsigned) * n_total);
+
+    // the counts of bin b are accumulated in bin_start[b + 1]
+    field->bin_start = malloc(sizeof(unsigned) * (n_total + 1));
+    for (unsigned b = 0; b <= n_total; b++) {
+        field->bin_start[b] = 0;
+    }
+    for (unsigned k = 0; k < n; k++) {
+        const double p[3] = {x[k], y[k], z[k]};
+        const unsigned m = planet_bins(field, centers, cos_reach, p, bins);
+        for (unsigned l = 0; l < m; l++) {
+            field->bin_start[bins[l] + 1] += 1;
+        }
+    }
+    for (unsigned b = 0; b < n_total; b++) {
+        field->bin_start[b + 1] += field->bin_start[b];
+        next[b] = field->bin_start[b];
+    }
+
+    const unsigned size = field->bin_start[n_total];
+    field->x = malloc(sizeof(double) * (size > 0 ? size : 1));
+    field->y = malloc(sizeof(double) * (size > 0 ? size : 1));
+    field->z = malloc(sizeof(double) * (size > 0 ? size : 1));
+    for (unsigned k = 0; k < n; k++) {
+        const double p[3] = {x[k], y[k], z[k]};
+        const unsigned m = planet_bins(field, centers, cos_reach, p, bins);
+        for (unsigned l = 0; l < m; l++) {
+            const unsigned i = next[bins[l]]++;
+            field->x[i] = x[k];
+            field->y[i] = y[k];
+            field->z[i] = z[k];
+        }
+    }
+
+    free(centers);
+    free(cos_reach);
+    free(bins);
+    free(next);
+}
+
+void grvx_field_init(struct GrvxField *field,
+                     const double *x,
+                     const double *y,
+                     const double *z,
+                     unsigned n,
+                     unsigned resolution,
+                     double r_near)
+{
+    field->n = resolution;
+    field->r_near = r_near;
+    field->cos_near = cos(r_near);
+
+    const unsigned size = 3 * grvx_field_size(field);
+    field->f = malloc(sizeof(double) * size);
+    for (unsigned k = 0; k < size; k++) {
+        field->f[k] = 0.;
+    }
+
+    // bins are about as wide as the near field
+    const double n_bins = ceil(M_PI / 2. / r_near);
+    field->n_bins = n_bins < GRVX_FIELD_MAX_BINS ? (unsigned)n_bins
+                                                 : GRVX_FIELD_MAX_BINS;
+    bin_planets(field, x, y, z, n);
+}
+
+void grvx_field_free(struct GrvxField *field)
+{
+    free(field->f);
+    free(field->bin_start);
+    free(field->x);
+    free(field->y);
+    free(field->z);
+}
+
+void grvx_field_node(const struct GrvxField *field, unsigned k, double q[3])
+{
+    const unsigned stride = field->n + 1;
+    const unsigned f = k / (stride * stride);
+    const unsigned i = k / stride % stride;
+    const unsigned j = k % stride;
+
+    const double h = 2. / field->n;
+    face_point(f, -1. + i * h, -1. + j * h, q);
+}
@@ -1,58 +1,31 @@
 #include "libgravix2/game.h"
 #include "libgravix2/config.h"
 #include "libgravix2/constants.h"
+#include "libgravix2/helpers.h"
 #include "libgravix2/observations.h"
-#include <assert.h>
+#include "libgravix2/planet.h"
+#include "libgravix2/spatial.h"
+#include "libgravix2/stats.h"
 #include <math.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
-static double linear_congruential_engine(unsigned *state)
+static double linear_congruential_engine(void *ctx)
 {
+    unsigned *state = ctx;
     *state = *state == 0 ? 1 : *state;
 
-    // as recommended by Park, Miller, and Stockmeyer (1993)
-    const unsigned a = 48271;
-    const unsigned c = 0;
-    const unsigned m = 2147483647;
+    // as recommended by Park, Miller, and Stockmeyer (1993); the product has
+    // to be computed in 64 bits, otherwise the period shrinks to ~30k draws
+    const uint64_t a = 48271;
+    const uint64_t c = 0;
+    const uint64_t m = 2147483647;
 
-    *state = (a * *state + c) % m;
+    *state = (unsigned)((a * *state + c) % m);
     return (double)*state / (double)m;
 }
 
-static double
-great_circle_distance(double lat1, double lat2, double lon1, double lon2)
-{
-    double s1 = sin(lat1);
-    double s2 = sin(lat2);
-    double c1 = cos(lat1);
-    double c2 = cos(lat2);
-    double d = cos(lon1 - lon2);
-    return acos(s1 * s2 + c1 * c2 * d);
-}
-
-static unsigned
-get_closest_planet(GrvxPlanetsHandle planets, double lat, double lon)
-{
-    double min_dist = 999.; // much larger than pi
-    unsigned planet = 0;
-
-    const unsigned n = grvx_count_planets(planets);
-    for (unsigned i = 0; i < n; i++) {
-        double p_lat;
-        double p_lon;
-        if (grvx_get_planet(planets, i, &p_lat, &p_lon) == 0) {
-            double dist = great_circle_distance(lat, p_lat, lon, p_lon);
-            if (dist < min_dist) {
-                min_dist = dist;
-                planet = i;
-            }
-        }
-    }
-
-    return planet;
-}
-
 static bool validate_launch(struct GrvxMissileLaunch *missile, double t)
 {
     return (t <= missile->t_start && //
@@ -61,65 +34,107 @@ static bool validate_launch(struct GrvxMissileLaunch *missile, double t)
             missile->dt_ping < missile->dt_end);
 }
 
-static void
-get_position(struct GrvxTrajectory *trj, uint32_t n, double *lat, double *lon)
-{
-    assert(n < GRVX_TRAJECTORY_SIZE);
-
-    double x = trj->x[n][0];
-    double y = trj->x[n][1];
-    double z = trj->x[n][2];
-
-    *lat = grvx_lat(z);
-    *lon = grvx_lon(x, y);
-}
-
-int grvx_rnd_init_planets(GrvxPlanetsHandle planets,
-                          unsigned *seed,
-                          double min_dist)
+/*
+ * Places the planets one by one at random positions. Each position is drawn
+ * from two uniform variates, which are returned by draw().
+ */
+static int sample_planets(GrvxPlanetsHandle planets,
+                          double min_dist,
+                          double (*draw)(void *),
+                          void *ctx)
 {
     const unsigned n_planets = grvx_count_planets(planets);
+    if (n_planets == 0) {
+        return 0;
+    }
 
-    double all_lats[n_planets];
-    double all_lons[n_planets];
+    // Candidates are only compared to the placed planets in the cells around
+    // them. Cells are at least as large as the typical distance between the
+    // planets s.t. sparse universes do not require too many empty cells.
+    const double spacing = sqrt(4. * M_PI / n_planets);
+    struct GrvxSpatialIndex idx;
+    grvx_spatial_index_init(
+        &idx, n_planets, min_dist > spacing ? min_dist : spacing);
+    const double cos_min_dist = cos(min_dist);
 
     int counter = 0;
     for (unsigned i = 0; i < n_planets; i++) {
-        double lat;
-        double lon;
+        double q[3];
 
         bool done;
         do {
-            lat = asin(2. * linear_congruential_engine(seed) - 1.);
-            lon = M_PI * (2. * linear_congruential_engine(seed) - 1.);
+            const double lat = asin(2. * draw(ctx) - 1.);
+            const double lon = M_PI * (2. * draw(ctx) - 1.);
             counter += 1;
 
-            done = true;
-            for (unsigned j = 0; j < i && done; j++) {
-                double lat2 = all_lats[j];
-                double lon2 = all_lons[j];
-                double dist = great_circle_distance(lat, lat2, lon, lon2);
-
-                done &= (dist >= min_dist);
-            }
+            grvx_set_planet(planets, i, lat, lon);
+            q[0] = planets->x[i];
+            q[1] = planets->y[i];
+            q[2] = planets->z[i];
 
+            done = min_dist <= 0. ||
+                   grvx_spatial_index_max_dot(&idx, q, min_dist, 0) <=
+                       cos_min_dist;
         } while (!done);
 
-        all_lats[i] = lat;
-        all_lons[i] = lon;
-        grvx_set_planet(planets, i, lat, lon);
+        grvx_spatial_index_insert(&idx, q);
     }
 
+    grvx_spatial_index_free(&idx);
+
     return counter;
 }
 
+int grvx_rnd_init_planets(GrvxPlanetsHandle planets,
+                          unsigned *seed,
+                          double min_dist)
+{
+    return sample_planets(planets, min_dist, linear_congruential_engine, seed);
+}
+
+static double rng_uniform(void *ctx)
+{
+    return grvx_rng_uniform(ctx);
+}
+
+int grvx_rng_init_planets(GrvxPlanetsHandle planets,
+                          struct GrvxRng *rng,
+                          double min_dist)
+{
+    return sample_planets(planets, min_dist, rng_uniform, rng);
+}
+
+/*
+ * Missile in flight. The state refers to the k-th sample after the launch,
+ * where consecutive samples are separated by 1 / GRVX_TRAJECTORY_SIZE ticks.
+ */
+struct GrvxFlight {
+    struct GrvxMissileState state;
+    unsigned k;
+    double t_start;
+    double h;
+    double t_ping;
+    double t_end;
+    bool pinged;
+};
+
+/*
+ * Games with a fixed capacity occupy a single block of memory, which holds the
+ * game followed by the missiles in flight and the heap of observations. Each
+ * missile in flight may cause up to two observations (its ping and its
+ * detonation), which are reserved upon launch s.t. the heap never overflows.
+ */
 struct GrvxGame {
     unsigned tick;
     GrvxPlanetsHandle planets;
-    GrvxTrajectoryBatch missiles;
+    struct GrvxFlight *flights;
+    unsigned n_flights;
+    unsigned capacity;
+    bool fixed;
+    unsigned reserved;
     double v0;
-    struct GrvxMissileObservation *observation;
-    struct GrvxMissileObservations *observations;
+    struct GrvxMissileObservation observation;
+    struct GrvxMissileObservations observations;
 };
 
 GrvxGameHandle grvx_init_game(GrvxPlanetsHandle planets)
@@ -128,97 +143,215 @@ GrvxGameHandle grvx_init_game(GrvxPlanetsHandle planets)
 
     game->tick = 0U;
     game->planets = planets;
-    game->missiles = grvx_new_missiles(1);
+    game->flights = 0;
+    game->n_flights = 0U;
+    game->capacity = 0U;
+    game->fixed = false;
+    game->reserved = 0U;
     game->v0 = grvx_v_esc();
-    game->observation = 0;
-    game->observations = 0;
+    init_observations(&game->observations, 16U);
 
     return game;
 }
 
-void grvx_delete_game(GrvxGameHandle game)
+GrvxGameHandle grvx_init_game_fixed(GrvxPlanetsHandle planets,
+                                    unsigned max_flights)
 {
-    grvx_delete_missiles(game->missiles);
+    const size_t size = sizeof(struct GrvxGame) +
+                        sizeof(struct GrvxFlight) * max_flights +
+                        sizeof(struct GrvxQueuedObservation) * 2 * max_flights;
+    struct GrvxGame *game = malloc(size);
+    if (game == 0) {
+        return 0;
+    }
+
+    game->tick = 0U;
+    game->planets = planets;
+    game->flights = (struct GrvxFlight *)(game + 1);
+    game->n_flights = 0U;
+    game->capacity = max_flights;
+    game->fixed = true;
+    game->reserved = 0U;
+    game->v0 = grvx_v_esc();
+    init_observations_in(
+        &game->observations,
+        (struct GrvxQueuedObservation *)(game->flights + max_flights),
+        2 * max_flights);
+
+    return game;
+}
 
-    delete_observations(game->observations);
-    free(game->observation);
+void grvx_delete_game(GrvxGameHandle game)
+{
+    if (!game->fixed) {
+        free(game->flights);
+        delete_observations(&game->observations);
+    }
 
     free(game);
 }
 
-int grvx_request_launch(GrvxGameHandle game,
-                        unsigned planet_id,
-                        struct GrvxMissileLaunch *missile,
-                        double dt)
+static int request_launch(GrvxGameHandle game,
+                          unsigned planet_id,
+                          struct GrvxMissileLaunch *missile,
+                          double dt)
 {
     if (!validate_launch(missile, game->tick)) {
         return 1;
     }
 
-    struct GrvxTrajectory *trj = grvx_get_trajectory(game->missiles, 0);
-    int rc = grvx_launch_missile(
-        trj, game->planets, planet_id, missile->v * game->v0, missile->psi);
+    struct GrvxMissileState state;
+    int rc = grvx_launch_missile_state(
+        &state, game->planets, planet_id, missile->v * game->v0, missile->psi);
     if (rc != 0) {
         return rc;
     }
 
-    const double trj_size = (double)GRVX_TRAJECTORY_SIZE;
-    const double h = dt / (double)GRVX_INT_STEPS / trj_size;
+    if (game->fixed && (game->n_flights == game->capacity ||
+                        game->observations.size + game->reserved + 2 >
+                            game->observations.capacity)) {
+        return 2;
+    }
 
-    double t = 0.;
+    if (game->n_flights == game->capacity) {
+        game->capacity = game->capacity > 0 ? 2 * game->capacity : 8;
+        game->flights =
+            realloc(game->flights, sizeof(struct GrvxFlight) * game->capacity);
+    }
 
-    int premature = 0;
-    while (premature != 1 && t < missile->t_start + missile->dt_end) {
-        unsigned n = grvx_propagate_missile(trj, game->planets, h, &premature);
-
-        bool ping = false;
-        bool detonation = false;
-
-        const double dt_ping = missile->t_start + missile->dt_ping - t;
-        const double dt_detonation = missile->t_start + missile->dt_end - t;
-
-        if (premature == 1) {
-            const double frac = (double)n / trj_size;
-            if (0. <= dt_ping && dt_ping < frac) {
-                ping = true;
-            }
-
-            if (frac <= dt_detonation) {
-                detonation = true;
-            }
-        } else if (0. <= dt_ping && dt_ping < 1.) {
-            ping = true;
-        }
+    // missiles are propagated lazily by grvx_observe_or_tick()
+    struct GrvxFlight *flight = &game->flights[game->n_flights];
+    flight->state = state;
+    flight->k = 0U;
+    flight->t_start = missile->t_start;
+    flight->h = dt / (double)GRVX_INT_STEPS / (double)GRVX_TRAJECTORY_SIZE;
+    flight->t_ping = missile->t_start + missile->dt_ping;
+    flight->t_end = missile->t_start + missile->dt_end;
+    flight->pinged = false;
+    game->n_flights += 1;
+    game->reserved += 2;
 
-        if (ping) {
-            struct GrvxMissileObservation *obs =
-                malloc(sizeof(struct GrvxMissileObservation));
-            obs->planet_id = grvx_count_planets(game->planets);
-            obs->t = missile->t_start + missile->dt_ping;
-            get_position(
-                trj, (uint32_t)(dt_ping * trj_size), &obs->lat, &obs->lon);
+    return 0;
+}
 
-            game->observations = add_observation(game->observations, obs);
-        }
+int grvx_request_launch(GrvxGameHandle game,
+                        unsigned planet_id,
+                        struct GrvxMissileLaunch *missile,
+                        double dt)
+{
+    GRVX_STATS_TIMER(t0);
+    const int rc = request_launch(game, planet_id, missile, dt);
+    GRVX_STATS_ADD_TIME(NS_REQUEST_LAUNCH, t0);
+    return rc;
+}
 
-        if (detonation) {
-            double lat, lon;
-            get_position(trj, n, &lat, &lon);
+static double flight_time(const struct GrvxFlight *flight)
+{
+    return flight->t_start + (double)flight->k / (double)GRVX_TRAJECTORY_SIZE;
+}
 
-            struct GrvxMissileObservation *obs =
-                malloc(sizeof(struct GrvxMissileObservation));
-            obs->planet_id = get_closest_planet(game->planets, lat, lon);
-            obs->t = t + (double)n / trj_size;
-            grvx_get_planet(
-                game->planets, obs->planet_id, &obs->lat, &obs->lon);
+struct FlightStep {
+    struct GrvxGame *game;
+    struct GrvxFlight *flight;
+    struct GrvxMissileState prev;
+};
 
-            game->observations = add_observation(game->observations, obs);
-        }
+static int
+flight_sink(void *ctx, unsigned i, const struct GrvxMissileState *state)
+{
+    struct FlightStep *step = ctx;
+    struct GrvxFlight *flight = step->flight;
+
+    const double t0 = flight_time(flight);
+    flight->k += 1;
+    const double t = flight_time(flight);
+
+    if (!flight->pinged && flight->t_ping < t) {
+        double x[3];
+        double v[3];
+        grvx_interpolate_on_sphere(step->prev.x,
+                                   step->prev.v,
+                                   state->x,
+                                   state->v,
+                                   GRVX_INT_STEPS * flight->h,
+                                   (flight->t_ping - t0) / (t - t0),
+                                   x,
+                                   v);
+
+        struct GrvxMissileObservation obs;
+        obs.planet_id = grvx_count_planets(step->game->planets);
+        obs.t = flight->t_ping;
+        obs.lat = grvx_lat(x[2]);
+        obs.lon = grvx_lon(x[0], x[1]);
+
+        add_observation(&step->game->observations, &obs);
+        flight->pinged = true;
+        step->game->reserved -= 1;
+    }
+
+    step->prev = *state;
+
+    // self-destruction
+    return t >= flight->t_end;
+}
 
-        t += 1.;
+/*
+ * Propagates a missile until it reaches the given tick. Returns true if the
+ * flight is over, i.e., if the missile detonated or self-destructed.
+ */
+static bool
+advance_flight(struct GrvxGame *game, struct GrvxFlight *flight, double t)
+{
+    const double t0 = flight_time(flight);
+    if (t0 >= t) {
+        return false;
     }
 
-    return 0;
+    const double n = ceil((t - t0) * (double)GRVX_TRAJECTORY_SIZE);
+    struct FlightStep step = {game, flight, flight->state};
+
+    int premature = 0;
+    grvx_stream_missile(&flight->state,
+                        game->planets,
+                        flight->h,
+                        GRVX_INT_STEPS,
+                        (unsigned)n,
+                        flight_sink,
+                        &step,
+                        &premature);
+
+    const double t1 = flight_time(flight);
+    if (premature && t1 <= flight->t_end) {
+        struct GrvxMissileObservation obs;
+        obs.planet_id = (unsigned)grvx_closest_planet(
+            game->planets,
+            grvx_lat(flight->state.x[2]),
+            grvx_lon(flight->state.x[0], flight->state.x[1]));
+        obs.t = t1;
+        grvx_get_planet(game->planets, obs.planet_id, &obs.lat, &obs.lon);
+
+        add_observation(&game->observations, &obs);
+    }
+
+    return premature || t1 >= flight->t_end;
+}
+
+/*
+ * Propagates all missiles in flight until they reach the given tick s.t. all
+ * observations up to this tick are known.
+ */
+static void advance_flights(struct GrvxGame *game, double t)
+{
+    unsigned i = 0;
+    while (i < game->n_flights) {
+        if (advance_flight(game, &game->flights[i], t)) {
+            game->reserved -= game->flights[i].pinged ? 1 : 2;
+            game->n_flights -= 1;
+            game->flights[i] = game->flights[game->n_flights];
+        } else {
+            i += 1;
+        }
+    }
 }
 
 struct GrvxMissileObservation *grvx_observe_or_tick(GrvxGameHandle game,
@@ -226,18 +359,281 @@ struct GrvxMissileObservation *grvx_observe_or_tick(GrvxGameHandle game,
 {
     struct GrvxMissileObservation *obs = 0;
 
-    if (game->observations == 0 ||
-        game->observations->obs->t > game->tick + 1) {
+    advance_flights(game, game->tick + 1.);
+
+    const struct GrvxMissileObservation *next =
+        peek_observation(&game->observations);
+    if (next == 0 || next->t > game->tick + 1) {
         game->tick += 1;
     } else {
-        free(game->observation);
-        game->observations =
-            pop_observation(game->observations, &game->observation);
-
-        obs = game->observation;
+        pop_observation(&game->observations, &game->observation);
+        obs = &game->observation;
     }
 
     *t = game->tick;
 
     return obs;
 }
+
+/*
+ * Snapshots consist of a header followed by the planets, the missiles in
+ * flight, and the heap of pending observations. All values are written in the
+ * byte order of the host. The header starts with a magic number, the format
+ * version, and a fingerprint of the configuration of the library.
+ */
+static const char SNAPSHOT_MAGIC[8] = {'G', 'R', 'V', 'X', 'G', 'A', 'M', 'E'};
+static const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+// sizes of the records of missiles in flight and of pending observations
+#define FLIGHT_RECORD_SIZE (10 * sizeof(double) + 2 * sizeof(uint32_t))
+#define OBSERVATION_RECORD_SIZE (4 * sizeof(double) + 2 * sizeof(uint32_t))
+
+struct SnapshotCursor {
+    unsigned char *buffer;
+    size_t size;
+    size_t pos;
+};
+
+struct SnapshotReader {
+    const unsigned char *buffer;
+    size_t size;
+    size_t pos;
+};
+
+static void put(struct SnapshotCursor *c, const void *data, size_t n)
+{
+    if (c->pos + n <= c->size) {
+        memcpy(c->buffer + c->pos, data, n);
+    }
+    c->pos += n;
+}
+
+static void put_u32(struct SnapshotCursor *c, uint32_t value)
+{
+    put(c, &value, sizeof(value));
+}
+
+static void put_u64(struct SnapshotCursor *c, uint64_t value)
+{
+    put(c, &value, sizeof(value));
+}
+
+static void put_f64(struct SnapshotCursor *c, double value)
+{
+    put(c, &value, sizeof(value));
+}
+
+static bool get(struct SnapshotReader *c, void *data, size_t n)
+{
+    if (n > c->size - c->pos) {
+        return false;
+    }
+    memcpy(data, c->buffer + c->pos, n);
+    c->pos += n;
+    return true;
+}
+
+static void put_config(struct SnapshotCursor *c)
+{
+    put_u32(c, GRVX_POT_TYPE);
+#if GRVX_POT_TYPE == GRVX_POT_TYPE_3D
+    put_u32(c, GRVX_N_POT);
+    put_u32(c, GRVX_POT_TABLE_SIZE);
+#else
+    put_u32(c, 0U);
+    put_u32(c, 0U);
+#endif
+    put_u32(c, GRVX_COMPOSITION_ID);
+    put_u32(c, GRVX_INT_STEPS);
+    put_u32(c, GRVX_TRAJECTORY_SIZE);
+    put_f64(c, GRVX_MIN_DIST);
+}
+
+static void put_header(struct SnapshotCursor *c)
+{
+    put(c, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    put_u32(c, GRVX_GAME_SNAPSHOT_VERSION);
+    put_u32(c, SNAPSHOT_BYTE_ORDER);
+    put_config(c);
+}
+
+size_t grvx_save_game(GrvxGameHandle game, void *buffer, size_t size)
+{
+    struct SnapshotCursor c = {buffer, size, 0};
+    put_header(&c);
+
+    const struct GrvxPlanets *planets = game->planets;
+    put_u32(&c, game->tick);
+    put_u32(&c, planets->n);
+    put_u32(&c, game->n_flights);
+    put_u32(&c, game->observations.size);
+    put_u64(&c, game->observations.seq);
+    put_f64(&c, planets->index->theta);
+    put_f64(&c, planets->index->field_r);
+    put_u32(&c, planets->index->field_n);
+    put_u32(&c, 0U);
+
+    put(&c, planets->x, sizeof(double) * planets->n);
+    put(&c, planets->y, sizeof(double) * planets->n);
+    put(&c, planets->z, sizeof(double) * planets->n);
+
+    for (unsigned i = 0; i < game->n_flights; i++) {
+        const struct GrvxFlight *flight = &game->flights[i];
+        put(&c, flight->state.x, sizeof(flight->state.x));
+        put(&c, flight->state.v, sizeof(flight->state.v));
+        put_f64(&c, flight->t_start);
+        put_f64(&c, flight->h);
+        put_f64(&c, flight->t_ping);
+        put_f64(&c, flight->t_end);
+        put_u32(&c, flight->k);
+        put_u32(&c, flight->pinged);
+    }
+
+    // the heap is stored as is s.t. ties are resolved identically
+    for (unsigned i = 0; i < game->observations.size; i++) {
+        const struct GrvxQueuedObservation *node = &game->observations.heap[i];
+        put_u64(&c, node->seq);
+        put_f64(&c, node->obs.t);
+        put_f64(&c, node->obs.lat);
+        put_f64(&c, node->obs.lon);
+        put_u32(&c, node->obs.planet_id);
+        put_u32(&c, 0U);
+    }
+
+    return c.pos;
+}
+
+/*
+ * Reads the counts and settings that follow the header and restores the
+ * planets.
+ */
+static GrvxPlanetsHandle load_planets(struct SnapshotReader *c,
+                                      uint32_t *tick,
+                                      uint32_t *n_flights,
+                                      uint32_t *n_obs,
+                                      uint64_t *seq)
+{
+    uint32_t n_planets;
+    double theta;
+    double field_r;
+    uint32_t field_n;
+    uint32_t padding;
+    if (!(get(c, tick, sizeof(*tick)) &&
+          get(c, &n_planets, sizeof(n_planets)) &&
+          get(c, n_flights, sizeof(*n_flights)) &&
+          get(c, n_obs, sizeof(*n_obs)) && get(c, seq, sizeof(*seq)) &&
+          get(c, &theta, sizeof(theta)) &&
+          get(c, &field_r, sizeof(field_r)) &&
+          get(c, &field_n, sizeof(field_n)) &&
+          get(c, &padding, sizeof(padding)))) {
+        return 0;
+    }
+
+    // guards the allocations below against corrupted counts
+    if (n_planets > (c->size - c->pos) / (3 * sizeof(double))) {
+        return 0;
+    }
+
+    GrvxPlanetsHandle planets = grvx_new_planets(n_planets);
+    const size_t n_bytes = sizeof(double) * n_planets;
+    if (!(get(c, planets->x, n_bytes) && get(c, planets->y, n_bytes) &&
+          get(c, planets->z, n_bytes)) ||
+        grvx_set_opening_angle(planets, theta) != 0 ||
+        grvx_bake_field(planets, field_n, field_r) != 0) {
+        grvx_delete_planets(planets);
+        return 0;
+    }
+
+    return planets;
+}
+
+static bool load_flight(struct SnapshotReader *c, struct GrvxFlight *flight)
+{
+    uint32_t pinged = 0;
+    const bool ok = get(c, flight->state.x, sizeof(flight->state.x)) &&
+                    get(c, flight->state.v, sizeof(flight->state.v)) &&
+                    get(c, &flight->t_start, sizeof(flight->t_start)) &&
+                    get(c, &flight->h, sizeof(flight->h)) &&
+                    get(c, &flight->t_ping, sizeof(flight->t_ping)) &&
+                    get(c, &flight->t_end, sizeof(flight->t_end)) &&
+                    get(c, &flight->k, sizeof(flight->k)) &&
+                    get(c, &pinged, sizeof(pinged));
+    flight->pinged = pinged != 0;
+    return ok;
+}
+
+static bool load_observation(struct SnapshotReader *c,
+                             struct GrvxQueuedObservation *node)
+{
+    uint32_t padding;
+    return get(c, &node->seq, sizeof(node->seq)) &&
+           get(c, &node->obs.t, sizeof(node->obs.t)) &&
+           get(c, &node->obs.lat, sizeof(node->obs.lat)) &&
+           get(c, &node->obs.lon, sizeof(node->obs.lon)) &&
+           get(c, &node->obs.planet_id, sizeof(node->obs.planet_id)) &&
+           get(c, &padding, sizeof(padding));
+}
+
+GrvxGameHandle
+grvx_load_game(const void *buffer, size_t size, GrvxPlanetsHandle *planets)
+{
+    // the expected header is compared byte by byte
+    unsigned char header[64];
+    struct SnapshotCursor expected = {header, sizeof(header), 0};
+    put_header(&expected);
+
+    struct SnapshotReader c = {buffer, size, expected.pos};
+    if (size < expected.pos || memcmp(buffer, header, expected.pos) != 0) {
+        return 0;
+    }
+
+    uint32_t tick;
+    uint32_t n_flights;
+    uint32_t n_obs;
+    uint64_t seq;
+    GrvxPlanetsHandle p = load_planets(&c, &tick, &n_flights, &n_obs, &seq);
+    if (p == 0) {
+        return 0;
+    }
+
+    // the remaining records have to fill the snapshot exactly
+    const uint64_t n_bytes = (uint64_t)n_flights * FLIGHT_RECORD_SIZE +
+                             (uint64_t)n_obs * OBSERVATION_RECORD_SIZE;
+    if (n_bytes != c.size - c.pos) {
+        grvx_delete_planets(p);
+        return 0;
+    }
+
+    struct GrvxGame *game = grvx_init_game(p);
+    game->tick = tick;
+
+    bool ok = true;
+    if (n_flights > 0) {
+        game->capacity = n_flights;
+        game->flights = malloc(sizeof(struct GrvxFlight) * n_flights);
+    }
+    for (unsigned i = 0; ok && i < n_flights; i++) {
+        ok = load_flight(&c, &game->flights[i]);
+        game->n_flights = i + 1;
+        game->reserved += game->flights[i].pinged ? 1 : 2;
+    }
+
+    if (n_obs > game->observations.capacity) {
+        delete_observations(&game->observations);
+        init_observations(&game->observations, n_obs);
+    }
+    for (unsigned i = 0; ok && i < n_obs; i++) {
+        ok = load_observation(&c, &game->observations.heap[i]);
+        game->observations.size = i + 1;
+    }
+    game->observations.seq = seq;
+
+    if (!ok) {
+        grvx_delete_game(game);
+        grvx_delete_planets(p);
+        return 0;
+    }
+
+    *planets = p;
+    return game;
+}
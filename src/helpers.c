@@ -1,6 +1,7 @@
 #include "libgravix2/helpers.h"
 
 #include <math.h>
+#include <stdint.h>
 
 #include "libgravix2/api.h"
 #include "libgravix2/linalg.h"
@@ -46,3 +47,170 @@ double grvx_sinc(double x)
 {
     return fabs(x) > 0. ? sin(x) / x : 1.;
 }
+
+void grvx_interpolate_on_sphere(const double *x0,
+                                const double *v0,
+                                const double *x1,
+                                const double *v1,
+                                double dt,
+                                double s,
+                                double *x,
+                                double *v)
+{
+    const double s2 = s * s;
+    const double s3 = s2 * s;
+
+    // cubic Hermite basis functions and their derivatives
+    const double h00 = 2. * s3 - 3. * s2 + 1.;
+    const double h10 = s3 - 2. * s2 + s;
+    const double h01 = 3. * s2 - 2. * s3;
+    const double h11 = s3 - s2;
+    const double dh00 = 6. * s2 - 6. * s;
+    const double dh10 = 3. * s2 - 4. * s + 1.;
+    const double dh11 = 3. * s2 - 2. * s;
+
+    double p[3];
+    double dp[3];
+    for (unsigned i = 0; i < 3; i++) {
+        p[i] = h00 * x0[i] + h10 * dt * v0[i] + h01 * x1[i] + h11 * dt * v1[i];
+        dp[i] = dh00 * (x0[i] - x1[i]) / dt + dh10 * v0[i] + dh11 * v1[i];
+    }
+
+    // project onto the unit sphere
+    const double norm = 1. / sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+    for (unsigned i = 0; i < 3; i++) {
+        x[i] = p[i] * norm;
+    }
+
+    const double radial = x[0] * dp[0] + x[1] * dp[1] + x[2] * dp[2];
+    for (unsigned i = 0; i < 3; i++) {
+        v[i] = (dp[i] - radial * x[i]) * norm;
+    }
+}
+
+static double sign(double x)
+{
+    return x < 0. ? -1. : 1.;
+}
+
+static double dequantize(uint16_t q)
+{
+    return (double)q / 65535. * 2. - 1.;
+}
+
+static uint16_t quantize(double u)
+{
+    const double q = floor((u * .5 + .5) * 65535.);
+    return (uint16_t)(q < 0. ? 0. : q > 65534. ? 65534. : q);
+}
+
+static void oct_decode(const uint16_t q[2], double x[3])
+{
+    double u = dequantize(q[0]);
+    double v = dequantize(q[1]);
+    const double w = 1. - fabs(u) - fabs(v);
+    if (w < 0.) {
+        const double u0 = u;
+        u = (1. - fabs(v)) * sign(u0);
+        v = (1. - fabs(u0)) * sign(v);
+    }
+
+    const double norm = 1. / sqrt(u * u + v * v + w * w);
+    x[0] = u * norm;
+    x[1] = v * norm;
+    x[2] = w * norm;
+}
+
+static void oct_encode(const double x[3], uint16_t q[2])
+{
+    const double l1 = fabs(x[0]) + fabs(x[1]) + fabs(x[2]);
+    double u = x[0] / l1;
+    double v = x[1] / l1;
+    if (x[2] < 0.) {
+        const double u0 = u;
+        u = (1. - fabs(v)) * sign(u0);
+        v = (1. - fabs(u0)) * sign(v);
+    }
+
+    // pick the closest of the four surrounding grid points
+    const uint16_t q0[2] = {quantize(u), quantize(v)};
+    double best = -2.;
+    for (uint16_t i = 0; i < 2; i++) {
+        for (uint16_t j = 0; j < 2; j++) {
+            const uint16_t c[2] = {(uint16_t)(q0[0] + i),
+                                   (uint16_t)(q0[1] + j)};
+            double y[3];
+            oct_decode(c, y);
+
+            const double cos_err = x[0] * y[0] + x[1] * y[1] + x[2] * y[2];
+            if (cos_err > best) {
+                best = cos_err;
+                q[0] = c[0];
+                q[1] = c[1];
+            }
+        }
+    }
+}
+
+static void tangent_basis(const double x[3], double e_lat[3], double e_lon[3])
+{
+    // same as in grvx_vlat() and grvx_vlon() but without trigonometric
+    // functions, where the longitude at the poles is zero
+    const double rho = sqrt(x[0] * x[0] + x[1] * x[1]);
+    const double sin_lon = rho > 0. ? x[0] / rho : 0.;
+    const double cos_lon = rho > 0. ? x[1] / rho : 1.;
+
+    e_lat[0] = -x[2] * sin_lon;
+    e_lat[1] = -x[2] * cos_lon;
+    e_lat[2] = rho;
+
+    e_lon[0] = cos_lon;
+    e_lon[1] = -sin_lon;
+    e_lon[2] = 0.;
+}
+
+void grvx_pack_sample(const struct GrvxMissileState *state,
+                      struct GrvxPackedSample *sample)
+{
+    oct_encode(state->x, sample->x);
+
+    // the velocity is projected onto the tangent plane of the decoded position
+    double x[3];
+    double e_lat[3];
+    double e_lon[3];
+    oct_decode(sample->x, x);
+    tangent_basis(x, e_lat, e_lon);
+
+    const double *v = state->v;
+    sample->v[0] = (float)(v[0] * e_lat[0] + v[1] * e_lat[1] + v[2] * e_lat[2]);
+    sample->v[1] = (float)(v[0] * e_lon[0] + v[1] * e_lon[1] + v[2] * e_lon[2]);
+}
+
+void grvx_unpack_sample(const struct GrvxPackedSample *sample,
+                        struct GrvxMissileState *state)
+{
+    double e_lat[3];
+    double e_lon[3];
+    oct_decode(sample->x, state->x);
+    tangent_basis(state->x, e_lat, e_lon);
+
+    const double vlat = (double)sample->v[0];
+    const double vlon = (double)sample->v[1];
+    for (unsigned i = 0; i < 3; i++) {
+        state->v[i] = vlat * e_lat[i] + vlon * e_lon[i];
+    }
+}
+
+double grvx_packed_lat(const struct GrvxPackedSample *sample)
+{
+    double x[3];
+    oct_decode(sample->x, x);
+    return grvx_lat(x[2]);
+}
+
+double grvx_packed_lon(const struct GrvxPackedSample *sample)
+{
+    double x[3];
+    oct_decode(sample->x, x);
+    return grvx_lon(x[0], x[1]);
+}
@@ -0,0 +1,230 @@
+#include "libgravix2/game.h"
+#include "libgravix2/pool.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+struct PendingLaunch {
+    unsigned planet_id;
+    struct GrvxMissileLaunch missile;
+    double dt;
+};
+
+/*
+ * Slot of a hosted game. Launches are queued by the control thread between
+ * rounds, whereas the output buffers are only written by the worker that
+ * advances the game during a round. Empty slots have no game and are reused.
+ */
+struct HostedGame {
+    GrvxGameHandle game;
+    struct PendingLaunch *pending;
+    unsigned n_pending;
+    unsigned pending_capacity;
+    int *launch_rc;
+    unsigned rc_capacity;
+    struct GrvxMissileObservation *observations;
+    unsigned obs_capacity;
+    struct GrvxHostOutput output;
+};
+
+struct GrvxGameHost {
+    struct GrvxPool *pool;
+    struct HostedGame *slots;
+    unsigned n_slots;
+    unsigned capacity;
+};
+
+static void clear_output(struct HostedGame *slot)
+{
+    slot->output.tick = 0U;
+    slot->output.n_launches = 0U;
+    slot->output.launch_rc = slot->launch_rc;
+    slot->output.n_observations = 0U;
+    slot->output.observations = slot->observations;
+}
+
+GrvxGameHostHandle grvx_new_game_host(GrvxPoolHandle pool)
+{
+    struct GrvxGameHost *host = malloc(sizeof(struct GrvxGameHost));
+
+    host->pool = pool;
+    host->slots = 0;
+    host->n_slots = 0U;
+    host->capacity = 0U;
+
+    return host;
+}
+
+void grvx_delete_game_host(GrvxGameHostHandle host)
+{
+    for (unsigned i = 0; i < host->n_slots; i++) {
+        struct HostedGame *slot = &host->slots[i];
+        if (slot->game != 0) {
+            grvx_delete_game(slot->game);
+        }
+        free(slot->pending);
+        free(slot->launch_rc);
+        free(slot->observations);
+    }
+
+    free(host->slots);
+    free(host);
+}
+
+unsigned grvx_host_game(GrvxGameHostHandle host, GrvxGameHandle game)
+{
+    unsigned i = 0;
+    while (i < host->n_slots && host->slots[i].game != 0) {
+        i += 1;
+    }
+
+    if (i == host->n_slots) {
+        if (host->n_slots == host->capacity) {
+            host->capacity = host->capacity > 0 ? 2 * host->capacity : 8;
+            host->slots = realloc(host->slots,
+                                  sizeof(struct HostedGame) * host->capacity);
+        }
+
+        struct HostedGame *slot = &host->slots[i];
+        slot->pending = 0;
+        slot->pending_capacity = 0U;
+        slot->launch_rc = 0;
+        slot->rc_capacity = 0U;
+        slot->observations = 0;
+        slot->obs_capacity = 0U;
+        host->n_slots += 1;
+    }
+
+    struct HostedGame *slot = &host->slots[i];
+    slot->game = game;
+    slot->n_pending = 0U;
+    clear_output(slot);
+
+    return i;
+}
+
+GrvxGameHandle grvx_unhost_game(GrvxGameHostHandle host, unsigned index)
+{
+    if (index >= host->n_slots) {
+        return 0;
+    }
+
+    struct HostedGame *slot = &host->slots[index];
+    GrvxGameHandle game = slot->game;
+    slot->game = 0;
+    slot->n_pending = 0U;
+    clear_output(slot);
+
+    return game;
+}
+
+GrvxGameHandle grvx_hosted_game(GrvxGameHostHandle host, unsigned index)
+{
+    return index < host->n_slots ? host->slots[index].game : 0;
+}
+
+int grvx_host_request_launch(GrvxGameHostHandle host,
+                             unsigned index,
+                             unsigned planet_id,
+                             const struct GrvxMissileLaunch *missile,
+                             double dt)
+{
+    if (index >= host->n_slots || host->slots[index].game == 0) {
+        return 1;
+    }
+
+    struct HostedGame *slot = &host->slots[index];
+    if (slot->n_pending == slot->pending_capacity) {
+        slot->pending_capacity =
+            slot->pending_capacity > 0 ? 2 * slot->pending_capacity : 8;
+        slot->pending =
+            realloc(slot->pending,
+                    sizeof(struct PendingLaunch) * slot->pending_capacity);
+    }
+
+    struct PendingLaunch *launch = &slot->pending[slot->n_pending];
+    launch->planet_id = planet_id;
+    launch->missile = *missile;
+    launch->dt = dt;
+    slot->n_pending += 1;
+
+    return 0;
+}
+
+static void add_output_observation(struct HostedGame *slot,
+                                   const struct GrvxMissileObservation *obs)
+{
+    const unsigned n = slot->output.n_observations;
+    if (n == slot->obs_capacity) {
+        slot->obs_capacity = slot->obs_capacity > 0 ? 2 * slot->obs_capacity
+                                                    : 16;
+        slot->observations =
+            realloc(slot->observations,
+                    sizeof(struct GrvxMissileObservation) * slot->obs_capacity);
+    }
+
+    slot->observations[n] = *obs;
+    slot->output.n_observations = n + 1;
+}
+
+/*
+ * Applies the queued launches of a game and advances it by one tick. The
+ * buffers of the slot are grown by the worker that owns the game in this
+ * round, i.e., no synchronization is needed.
+ */
+static void advance_game(struct HostedGame *slot)
+{
+    if (slot->n_pending > slot->rc_capacity) {
+        slot->rc_capacity = slot->n_pending;
+        slot->launch_rc =
+            realloc(slot->launch_rc, sizeof(int) * slot->rc_capacity);
+    }
+
+    for (unsigned k = 0; k < slot->n_pending; k++) {
+        struct PendingLaunch *launch = &slot->pending[k];
+        slot->launch_rc[k] = grvx_request_launch(
+            slot->game, launch->planet_id, &launch->missile, launch->dt);
+    }
+    slot->output.n_launches = slot->n_pending;
+    slot->n_pending = 0U;
+
+    slot->output.n_observations = 0U;
+    unsigned t;
+    const struct GrvxMissileObservation *obs;
+    while ((obs = grvx_observe_or_tick(slot->game, &t)) != 0) {
+        add_output_observation(slot, obs);
+    }
+
+    // buffers may have been moved by the reallocations above
+    slot->output.tick = t;
+    slot->output.launch_rc = slot->launch_rc;
+    slot->output.observations = slot->observations;
+}
+
+static void advance_chunk(void *ctx, unsigned begin, unsigned end)
+{
+    struct GrvxGameHost *host = ctx;
+    for (unsigned i = begin; i < end; i++) {
+        if (host->slots[i].game != 0) {
+            advance_game(&host->slots[i]);
+        }
+    }
+}
+
+void grvx_run_host_round(GrvxGameHostHandle host)
+{
+    // games differ a lot in their number of missiles and are thus handed out
+    // one by one s.t. idle workers can steal any of them
+    if (host->n_slots > 0) {
+        grvx_pool_run(host->pool, host->n_slots, 1U, advance_chunk, host);
+    }
+}
+
+const struct GrvxHostOutput *grvx_host_output(GrvxGameHostHandle host,
+                                              unsigned index)
+{
+    if (index >= host->n_slots || host->slots[index].game == 0) {
+        return 0;
+    }
+
+    return &host->slots[index].output;
+}
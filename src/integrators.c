@@ -2,10 +2,17 @@
 
 #include <assert.h>
 #include <math.h>
+#include <stdbool.h>
 
 #include "libgravix2/config.h"
+#include "libgravix2/constants.h"
 #include "libgravix2/helpers.h"
 #include "libgravix2/pot.h"
+#include "libgravix2/stats.h"
+
+// absorbs round-off errors (also of single precision sweeps) of the angles
+// that are compared in may_be_close()
+#define MIN_DIST_MARGIN 1e-4
 
 #if GRVX_COMPOSITION_P2S1 == GRVX_COMPOSITION_ID
 // Vanilla Strang splitting
@@ -105,13 +112,13 @@ static void strang1(struct GrvxQP *qp, struct GrvxQP *e, double h)
     *qp = qp2;
 }
 
-static void strang2(struct GrvxQP *qp,
-                    struct GrvxQP *e,
-                    double h,
-                    const struct GrvxPlanets *planets)
+static double strang2(struct GrvxQP *qp,
+                      struct GrvxQP *e,
+                      double h,
+                      const struct GrvxPlanets *planets)
 {
     struct GrvxVec3D v = qp->q;
-    grvx_gradV(&v, planets);
+    const double mdist = grvx_gradV_min_dist(&v, planets);
     const double q_dot_gradV = grvx_dot(qp->q, v);
 
     struct GrvxVec3D dp = {
@@ -138,24 +145,193 @@ static void strang2(struct GrvxQP *qp,
     e->p.z += qp->p.z - qp2.p.z;
 
     *qp = qp2;
+    return mdist;
 }
 
-void grvx_integration_step(struct GrvxQP *qp,
-                           struct GrvxQP *e,
-                           double h,
-                           const struct GrvxPlanets *planets)
+/*
+ * The final drift of a step moves the missile by the angle |p| GAMMA[n-1] h / 2
+ * away from the position of the last force evaluation, whose planet sweep
+ * also yielded mdist. Due to the triangle inequality, the missile can only have
+ * come closer than GRVX_MIN_DIST to any planet if it was closer than
+ * GRVX_MIN_DIST plus this angle before, i.e., the distances to the planets
+ * have to be recomputed only close to them.
+ */
+static bool may_be_close(double mdist, double p2, double h)
 {
+    const double drift =
+        sqrt(p2) * fabs(GAMMA[GRVX_COMPOSITION_STAGES - 1] * h) / 2.;
+    const double reach = GRVX_MIN_DIST + drift + MIN_DIST_MARGIN;
+    return reach >= M_PI || mdist >= cos(reach);
+}
+
+double grvx_integration_step(struct GrvxQP *qp,
+                             struct GrvxQP *e,
+                             double h,
+                             const struct GrvxPlanets *planets)
+{
+    double mdist = -1.;
+    GRVX_STATS_ADD(STEPS, 1);
+
     strang1(qp, e, GAMMA[0] * h / 2.);
     for (unsigned i = 0; i < GRVX_COMPOSITION_STAGES; i++) {
         const double g2 = GAMMA[i];
         const double g1 =
             g2 + (i + 1 < GRVX_COMPOSITION_STAGES ? GAMMA[i + 1] : 0.);
 
-        strang2(qp, e, g2 * h, planets);
+        mdist = strang2(qp, e, g2 * h, planets);
         strang1(qp, e, g1 * h / 2.);
     }
+
+    if (may_be_close(mdist, grvx_dot(qp->p, qp->p), h)) {
+        mdist = grvx_min_dist(&qp->q, planets);
+    }
+
+    return mdist;
+}
+
+static void
+strang1_lanes(struct GrvxQPLanes *qp, struct GrvxQPLanes *e, double h)
+{
+    double p2[GRVX_SIMD_LANES];
+    double h_sinc_ph[GRVX_SIMD_LANES];
+    double cos_ph_minus_one[GRVX_SIMD_LANES];
+
+    for (unsigned l = 0; l < GRVX_SIMD_LANES; l++) {
+        p2[l] = qp->p.x[l] * qp->p.x[l] + qp->p.y[l] * qp->p.y[l] +
+                qp->p.z[l] * qp->p.z[l];
+    }
+
+    // transcendental functions are evaluated separately s.t. the surrounding
+    // loops can be vectorized
+    for (unsigned l = 0; l < GRVX_SIMD_LANES; l++) {
+        const double ph = sqrt(p2[l]) * h;
+        h_sinc_ph[l] = h * grvx_sinc(ph);
+        cos_ph_minus_one[l] = -2. * pow(sin(ph / 2.), 2);
+    }
+
+    for (unsigned l = 0; l < GRVX_SIMD_LANES; l++) {
+        const double c = cos_ph_minus_one[l];
+        const double s = h_sinc_ph[l];
+
+        const double qx = qp->q.x[l];
+        const double qy = qp->q.y[l];
+        const double qz = qp->q.z[l];
+        const double px = qp->p.x[l];
+        const double py = qp->p.y[l];
+        const double pz = qp->p.z[l];
+
+        e->q.x[l] += qx * c + px * s;
+        e->q.y[l] += qy * c + py * s;
+        e->q.z[l] += qz * c + pz * s;
+        e->p.x[l] += px * c - qx * p2[l] * s;
+        e->p.y[l] += py * c - qy * p2[l] * s;
+        e->p.z[l] += pz * c - qz * p2[l] * s;
+
+        qp->q.x[l] = qx + e->q.x[l];
+        qp->q.y[l] = qy + e->q.y[l];
+        qp->q.z[l] = qz + e->q.z[l];
+        qp->p.x[l] = px + e->p.x[l];
+        qp->p.y[l] = py + e->p.y[l];
+        qp->p.z[l] = pz + e->p.z[l];
+
+        e->q.x[l] += qx - qp->q.x[l];
+        e->q.y[l] += qy - qp->q.y[l];
+        e->q.z[l] += qz - qp->q.z[l];
+        e->p.x[l] += px - qp->p.x[l];
+        e->p.y[l] += py - qp->p.y[l];
+        e->p.z[l] += pz - qp->p.z[l];
+    }
+}
+
+static void strang1_lanes_f32(struct GrvxQPLanesF32 *qp,
+                              struct GrvxQPLanesF32 *e,
+                              float h)
+{
+    float p2[GRVX_SIMD_LANES_F32];
+    float h_sinc_ph[GRVX_SIMD_LANES_F32];
+    float cos_ph_minus_one[GRVX_SIMD_LANES_F32];
+
+    for (unsigned l = 0; l < GRVX_SIMD_LANES_F32; l++) {
+        p2[l] = qp->p.x[l] * qp->p.x[l] + qp->p.y[l] * qp->p.y[l] +
+                qp->p.z[l] * qp->p.z[l];
+    }
+
+    // Taylor polynomials are accurate to single precision for (ph)^2 <= 1
+    // and, in contrast to sinf, can be vectorized
+    bool large_ph = false;
+    for (unsigned l = 0; l < GRVX_SIMD_LANES_F32; l++) {
+        const float x2 = p2[l] * h * h;
+        const float sinc =
+            1.f - x2 / 6.f * (1.f - x2 / 20.f * (1.f - x2 / 42.f *
+                                                           (1.f - x2 / 72.f)));
+        const float cos_minus_one =
+            -x2 / 2.f *
+            (1.f - x2 / 12.f *
+                       (1.f - x2 / 30.f *
+                                  (1.f - x2 / 56.f * (1.f - x2 / 90.f))));
+
+        h_sinc_ph[l] = h * sinc;
+        cos_ph_minus_one[l] = cos_minus_one;
+        large_ph |= x2 > 1.f;
+    }
+
+    if (large_ph) {
+        for (unsigned l = 0; l < GRVX_SIMD_LANES_F32; l++) {
+            const float ph = sqrtf(p2[l]) * h;
+            const float sin_ph_2 = sinf(ph / 2.f);
+            h_sinc_ph[l] = h * (fabsf(ph) > 0.f ? sinf(ph) / ph : 1.f);
+            cos_ph_minus_one[l] = -2.f * sin_ph_2 * sin_ph_2;
+        }
+    }
+
+    for (unsigned l = 0; l < GRVX_SIMD_LANES_F32; l++) {
+        const float c = cos_ph_minus_one[l];
+        const float s = h_sinc_ph[l];
+
+        const float qx = qp->q.x[l];
+        const float qy = qp->q.y[l];
+        const float qz = qp->q.z[l];
+        const float px = qp->p.x[l];
+        const float py = qp->p.y[l];
+        const float pz = qp->p.z[l];
+
+        e->q.x[l] += qx * c + px * s;
+        e->q.y[l] += qy * c + py * s;
+        e->q.z[l] += qz * c + pz * s;
+        e->p.x[l] += px * c - qx * p2[l] * s;
+        e->p.y[l] += py * c - qy * p2[l] * s;
+        e->p.z[l] += pz * c - qz * p2[l] * s;
+
+        qp->q.x[l] = qx + e->q.x[l];
+        qp->q.y[l] = qy + e->q.y[l];
+        qp->q.z[l] = qz + e->q.z[l];
+        qp->p.x[l] = px + e->p.x[l];
+        qp->p.y[l] = py + e->p.y[l];
+        qp->p.z[l] = pz + e->p.z[l];
+
+        e->q.x[l] += qx - qp->q.x[l];
+        e->q.y[l] += qy - qp->q.y[l];
+        e->q.z[l] += qz - qp->q.z[l];
+        e->p.x[l] += px - qp->p.x[l];
+        e->p.y[l] += py - qp->p.y[l];
+        e->p.z[l] += pz - qp->p.z[l];
+    }
 }
 
+#define SUFFIX
+#define REAL double
+#define N_LANES GRVX_SIMD_LANES
+#define QP_LANES GrvxQPLanes
+#define VEC_LANES GrvxVec3DLanes
+#include "libgravix2/integrators_lanes.h"
+
+#define SUFFIX _f32
+#define REAL float
+#define N_LANES GRVX_SIMD_LANES_F32
+#define QP_LANES GrvxQPLanesF32
+#define VEC_LANES GrvxVec3DLanesF32
+#include "libgravix2/integrators_lanes.h"
+
 unsigned grvx_integration_loop(struct GrvxQP *qp,
                                double h,
                                unsigned n,
@@ -166,8 +342,7 @@ unsigned grvx_integration_loop(struct GrvxQP *qp,
 
     struct GrvxQP e = {{0., 0., 0.}, {0., 0., 0.}};
     for (; n > 0 && mdist < threshold; n--) {
-        grvx_integration_step(qp, &e, h, planets);
-        mdist = grvx_min_dist(&qp->q, planets);
+        mdist = grvx_integration_step(qp, &e, h, planets);
         assert(fabs(mdist) <= 1);
     }
 
@@ -183,3 +358,58 @@ unsigned grvx_integration_loop(struct GrvxQP *qp,
 
     return n;
 }
+
+double grvx_adaptive_integration_loop(struct GrvxQP *qp,
+                                      double *rho,
+                                      double t,
+                                      double eps,
+                                      const struct GrvxPlanets *planets)
+{
+    double mdist = -1.;
+    const double threshold = cos(GRVX_MIN_DIST);
+
+    double dlog_sigma;
+    double sigma = grvx_step_control(&qp->q, &qp->p, planets, &dlog_sigma);
+
+    // Hairer & Soederlind (2005), DOI:10.1137/040606995: the staggered
+    // control variable rho_{n+1/2} = rho_{n-1/2} + eps G(y_n) with G = -d/dt
+    // ln(sigma) keeps rho sigma ~ 1 and the step sizes h_n = eps / rho_{n+1/2}
+    // symmetric under time reversal
+    if (!(*rho > 0.)) {
+        *rho = 1. / sigma + eps / 2. * dlog_sigma;
+    }
+
+    struct GrvxQP e = {{0., 0., 0.}, {0., 0., 0.}};
+    while (t > 0. && mdist < threshold) {
+        *rho -= eps * dlog_sigma;
+        if (!(*rho > 0.)) {
+            // eps is too large to resolve the variation of sigma
+            *rho = 1. / sigma;
+        }
+
+        // the last step is stretched or shortened to end exactly at t, which
+        // is the only deviation from a reversible step sequence
+        double h = eps / *rho;
+        if (t - h < h / 4.) {
+            h = t;
+        }
+
+        mdist = grvx_integration_step(qp, &e, h, planets);
+        assert(fabs(mdist) <= 1);
+        t -= h;
+
+        sigma = grvx_step_control(&qp->q, &qp->p, planets, &dlog_sigma);
+    }
+
+    const double q_norm = 1. / grvx_mag(qp->q);
+    qp->q.x *= q_norm;
+    qp->q.y *= q_norm;
+    qp->q.z *= q_norm;
+
+    const double error = grvx_dot(qp->q, qp->p);
+    qp->p.x -= error * qp->q.x;
+    qp->p.y -= error * qp->q.y;
+    qp->p.z -= error * qp->q.z;
+
+    return t;
+}
@@ -1,13 +1,17 @@
 #include <assert.h>
 #include <math.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
 
 #include "libgravix2/api.h"
 #include "libgravix2/config.h"
+#include "libgravix2/helpers.h"
 #include "libgravix2/integrators.h"
 #include "libgravix2/planet.h"
+#include "libgravix2/pool.h"
 #include "libgravix2/pot.h"
+#include "libgravix2/stats.h"
 
 GrvxTrajectoryBatch grvx_new_missiles(unsigned n)
 {
@@ -25,27 +29,38 @@ struct GrvxTrajectory *grvx_get_trajectory(GrvxTrajectoryBatch batch,
     return batch + i;
 }
 
-int grvx_init_missile(struct GrvxTrajectory *t,
-                      double lat,
-                      double lon,
-                      double v,
-                      double dlat,
-                      double dlon)
+static void init_state(double x[3],
+                       double v[3],
+                       double lat,
+                       double lon,
+                       double v_abs,
+                       double dlat,
+                       double dlon)
 {
     const double sin_lat = sin(lat);
     const double cos_lat = cos(lat);
     const double sin_lon = sin(lon);
     const double cos_lon = cos(lon);
 
-    t->x[0][0] = cos_lat * sin_lon;
-    t->x[0][1] = cos_lat * cos_lon;
-    t->x[0][2] = sin_lat;
+    x[0] = cos_lat * sin_lon;
+    x[1] = cos_lat * cos_lon;
+    x[2] = sin_lat;
 
     const double dv = sqrt(dlat * dlat + dlon * dlon);
     assert(dv > 0.);
-    t->v[0][0] = v * (-dlat * sin_lat * sin_lon + dlon * cos_lon) / dv;
-    t->v[0][1] = v * (-dlat * sin_lat * cos_lon - dlon * sin_lon) / dv;
-    t->v[0][2] = v * dlat * cos_lat / dv;
+    v[0] = v_abs * (-dlat * sin_lat * sin_lon + dlon * cos_lon) / dv;
+    v[1] = v_abs * (-dlat * sin_lat * cos_lon - dlon * sin_lon) / dv;
+    v[2] = v_abs * dlat * cos_lat / dv;
+}
+
+int grvx_init_missile(struct GrvxTrajectory *t,
+                      double lat,
+                      double lon,
+                      double v,
+                      double dlat,
+                      double dlon)
+{
+    init_state(t->x[0], t->v[0], lat, lon, v, dlat, dlon);
 
     for (int i = 0; i < 3; i++) {
         t->x[GRVX_TRAJECTORY_SIZE - 1][i] = t->x[0][i];
@@ -55,6 +70,17 @@ int grvx_init_missile(struct GrvxTrajectory *t,
     return 0;
 }
 
+int grvx_init_missile_state(struct GrvxMissileState *state,
+                            double lat,
+                            double lon,
+                            double v,
+                            double dlat,
+                            double dlon)
+{
+    init_state(state->x, state->v, lat, lon, v, dlat, dlon);
+    return 0;
+}
+
 static void rotation_matrix(double lat, double lon, struct GrvxVec3D rot[3])
 {
     double sin_lat = sin(lat);
@@ -90,9 +116,8 @@ static void prepare_launch(GrvxPlanetsHandle planets,
                            struct GrvxVec3D *v)
 {
     struct GrvxVec3D rot[3];
-    ptrdiff_t offset = 3 * (ptrdiff_t)planet;
-    rotation_matrix(grvx_lat(planets->data[offset + 2]),
-                    grvx_lon(planets->data[offset], planets->data[offset + 1]),
+    rotation_matrix(grvx_lat(planets->z[planet]),
+                    grvx_lon(planets->x[planet], planets->y[planet]),
                     rot);
 
     const double sin_r = sin(GRVX_MIN_DIST);
@@ -121,27 +146,25 @@ static void prepare_launch(GrvxPlanetsHandle planets,
     v->z = grvx_dot(rot[2], v0);
 }
 
-int grvx_launch_missile(struct GrvxTrajectory *t,
-                        GrvxPlanetsHandle planets,
-                        unsigned planet,
-                        double v_abs,
-                        double psi)
+static void launch_orientation(GrvxPlanetsHandle planets,
+                               unsigned planet,
+                               double psi,
+                               double *lat,
+                               double *lon,
+                               double *dlat,
+                               double *dlon)
 {
-    if (planet >= planets->n) {
-        return -1;
-    }
-
     struct GrvxVec3D x;
     struct GrvxVec3D v;
     prepare_launch(planets, planet, psi, &x, &v);
 
-    const double lat = grvx_lat(x.z);
-    const double lon = grvx_lon(x.x, x.y);
+    *lat = grvx_lat(x.z);
+    *lon = grvx_lon(x.x, x.y);
 
-    const double sin_lat = sin(lat);
-    const double cos_lat = cos(lat);
-    const double sin_lon = sin(lon);
-    const double cos_lon = cos(lon);
+    const double sin_lat = sin(*lat);
+    const double cos_lat = cos(*lat);
+    const double sin_lon = sin(*lon);
+    const double cos_lon = cos(*lon);
 
     struct GrvxVec3D e_lat = {
         -sin_lat * sin_lon,
@@ -154,16 +177,67 @@ int grvx_launch_missile(struct GrvxTrajectory *t,
         0.,
     };
 
-    const double dlat = grvx_dot(v, e_lat);
-    const double dlon = grvx_dot(v, e_lon);
+    *dlat = grvx_dot(v, e_lat);
+    *dlon = grvx_dot(v, e_lon);
+}
+
+int grvx_launch_missile(struct GrvxTrajectory *t,
+                        GrvxPlanetsHandle planets,
+                        unsigned planet,
+                        double v_abs,
+                        double psi)
+{
+    if (planet >= planets->n) {
+        return -1;
+    }
+
+    double lat, lon, dlat, dlon;
+    launch_orientation(planets, planet, psi, &lat, &lon, &dlat, &dlon);
     return grvx_init_missile(t, lat, lon, v_abs, dlat, dlon);
 }
 
+int grvx_launch_missile_state(struct GrvxMissileState *state,
+                              GrvxPlanetsHandle planets,
+                              unsigned planet,
+                              double v_abs,
+                              double psi)
+{
+    if (planet >= planets->n) {
+        return -1;
+    }
+
+    double lat, lon, dlat, dlon;
+    launch_orientation(planets, planet, psi, &lat, &lon, &dlat, &dlon);
+    return grvx_init_missile_state(state, lat, lon, v_abs, dlat, dlon);
+}
+
+int grvx_launch_missiles(GrvxTrajectoryBatch batch,
+                         unsigned n,
+                         GrvxPlanetsHandle planets,
+                         const unsigned *planet,
+                         const double *v_abs,
+                         const double *psi)
+{
+    // validate first s.t. either all or none of the missiles are launched
+    for (unsigned i = 0; i < n; i++) {
+        if (planet[i] >= planets->n) {
+            return -1;
+        }
+    }
+
+    for (unsigned i = 0; i < n; i++) {
+        grvx_launch_missile(batch + i, planets, planet[i], v_abs[i], psi[i]);
+    }
+
+    return 0;
+}
+
 unsigned grvx_propagate_missile(struct GrvxTrajectory *trj,
                                 GrvxPlanetsHandle planets,
                                 double h,
                                 int *premature)
 {
+    GRVX_STATS_TIMER(t0);
     struct GrvxQP qp = {
         .q.x = trj->x[GRVX_TRAJECTORY_SIZE - 1][0],
         .q.y = trj->x[GRVX_TRAJECTORY_SIZE - 1][1],
@@ -190,9 +264,244 @@ unsigned grvx_propagate_missile(struct GrvxTrajectory *trj,
         trj->v[i][2] = qp.p.z;
     }
 
+    GRVX_STATS_ADD(PREMATURE, *premature != 0);
+    GRVX_STATS_ADD_TIME(NS_PROPAGATE, t0);
     return i;
 }
 
+unsigned grvx_propagate_missile_adaptive(struct GrvxTrajectory *trj,
+                                         GrvxPlanetsHandle planets,
+                                         double h,
+                                         double h_max,
+                                         int *premature)
+{
+    struct GrvxQP qp = {
+        .q.x = trj->x[GRVX_TRAJECTORY_SIZE - 1][0],
+        .q.y = trj->x[GRVX_TRAJECTORY_SIZE - 1][1],
+        .q.z = trj->x[GRVX_TRAJECTORY_SIZE - 1][2],
+        .p.x = trj->v[GRVX_TRAJECTORY_SIZE - 1][0],
+        .p.y = trj->v[GRVX_TRAJECTORY_SIZE - 1][1],
+        .p.z = trj->v[GRVX_TRAJECTORY_SIZE - 1][2],
+    };
+
+    // same time span between consecutive trajectory points as in
+    // grvx_propagate_missile()
+    const double dt = GRVX_INT_STEPS * h;
+
+    double rho = 0.;
+    unsigned i = 0;
+    for (*premature = 0; i < GRVX_TRAJECTORY_SIZE && !*premature; i++) {
+        double t_left =
+            grvx_adaptive_integration_loop(&qp, &rho, dt, h_max, planets);
+        *premature = (t_left > 0.);
+
+        assert(fabs(grvx_dot(qp.q, qp.q) - 1.) < 1e-10);
+        assert(fabs(grvx_dot(qp.p, qp.q)) < 1e-10);
+
+        trj->x[i][0] = qp.q.x;
+        trj->x[i][1] = qp.q.y;
+        trj->x[i][2] = qp.q.z;
+        trj->v[i][0] = qp.p.x;
+        trj->v[i][1] = qp.p.y;
+        trj->v[i][2] = qp.p.z;
+    }
+
+    GRVX_STATS_ADD(PREMATURE, *premature != 0);
+    return i;
+}
+
+unsigned grvx_stream_missile(struct GrvxMissileState *state,
+                             GrvxPlanetsHandle planets,
+                             double h,
+                             unsigned n_steps,
+                             unsigned n_samples,
+                             GrvxSampleSink sink,
+                             void *ctx,
+                             int *premature)
+{
+    struct GrvxQP qp = {
+        .q.x = state->x[0],
+        .q.y = state->x[1],
+        .q.z = state->x[2],
+        .p.x = state->v[0],
+        .p.y = state->v[1],
+        .p.z = state->v[2],
+    };
+
+    unsigned i = 0;
+    for (*premature = 0; i < n_samples && !*premature;) {
+        unsigned n_left = grvx_integration_loop(&qp, h, n_steps, planets);
+        *premature = (n_left != 0);
+
+        assert(fabs(grvx_dot(qp.q, qp.q) - 1.) < 1e-10);
+        assert(fabs(grvx_dot(qp.p, qp.q)) < 1e-10);
+
+        state->x[0] = qp.q.x;
+        state->x[1] = qp.q.y;
+        state->x[2] = qp.q.z;
+        state->v[0] = qp.p.x;
+        state->v[1] = qp.p.y;
+        state->v[2] = qp.p.z;
+
+        if (sink(ctx, i++, state) != 0) {
+            break;
+        }
+    }
+
+    GRVX_STATS_ADD(PREMATURE, *premature != 0);
+    return i;
+}
+
+int grvx_ring_sink(void *ring, unsigned i, const struct GrvxMissileState *state)
+{
+    struct GrvxSampleRing *r = ring;
+    r->samples[r->head] = *state;
+    r->head = r->head + 1 < r->size ? r->head + 1 : 0;
+    if (r->count < r->size) {
+        r->count += 1;
+    }
+    return 0;
+}
+
+static int
+pack_sink(void *ctx, unsigned i, const struct GrvxMissileState *state)
+{
+    struct GrvxPackedTrajectory *trj = ctx;
+    grvx_pack_sample(state, &trj->samples[i]);
+    return 0;
+}
+
+unsigned grvx_propagate_missile_packed(struct GrvxPackedTrajectory *trj,
+                                       GrvxPlanetsHandle planets,
+                                       double h,
+                                       int *premature)
+{
+    // trj->state keeps the last sample in full precision for chained calls
+    return grvx_stream_missile(&trj->state,
+                               planets,
+                               h,
+                               GRVX_INT_STEPS,
+                               GRVX_TRAJECTORY_SIZE,
+                               pack_sink,
+                               trj,
+                               premature);
+}
+
+#define SUFFIX
+#define REAL double
+#define N_LANES GRVX_SIMD_LANES
+#define QP_LANES GrvxQPLanes
+#define CARRY_ERROR false
+#include "libgravix2/missile_lanes.h"
+
+// the rounding error is carried over into the compensated summation s.t. the
+// low-order bits of the state do not get lost at every sample
+#define SUFFIX _f32
+#define REAL float
+#define N_LANES GRVX_SIMD_LANES_F32
+#define QP_LANES GrvxQPLanesF32
+#define CARRY_ERROR true
+#include "libgravix2/missile_lanes.h"
+
+void grvx_propagate_missiles(GrvxTrajectoryBatch batch,
+                             uint32_t n,
+                             GrvxPlanetsHandle planets,
+                             double h,
+                             uint32_t *n_steps,
+                             int32_t *premature)
+{
+    propagate_lanes(batch, n, planets, h, n_steps, premature);
+}
+
+struct BatchJob {
+    GrvxTrajectoryBatch batch;
+    GrvxPlanetsHandle planets;
+    double h;
+    uint32_t *n_steps;
+    int32_t *premature;
+};
+
+static void propagate_chunk(void *ctx, uint32_t begin, uint32_t end)
+{
+    const struct BatchJob *job = ctx;
+    grvx_propagate_missiles(job->batch + begin,
+                            end - begin,
+                            job->planets,
+                            job->h,
+                            job->n_steps + begin,
+                            job->premature + begin);
+}
+
+void grvx_propagate_batch_parallel(GrvxPoolHandle pool,
+                                   GrvxTrajectoryBatch batch,
+                                   uint32_t n,
+                                   GrvxPlanetsHandle planets,
+                                   double h,
+                                   uint32_t *n_steps,
+                                   int32_t *premature)
+{
+    // Lanes are refilled only within a chunk, i.e., the last missiles of each
+    // chunk run with idle lanes. Large chunks amortize this, whereas small
+    // chunks allow for a finer balancing of the load between the threads.
+    const uint32_t lanes = GRVX_SIMD_LANES;
+    const uint32_t per_thread = n / (4 * pool->n_threads) / lanes * lanes;
+    uint32_t chunk = per_thread < 16 * lanes ? per_thread : 16 * lanes;
+    chunk = chunk > lanes ? chunk : lanes;
+
+    struct BatchJob job = {
+        .batch = batch,
+        .planets = planets,
+        .h = h,
+        .n_steps = n_steps,
+        .premature = premature,
+    };
+    grvx_pool_run(pool, n, chunk, propagate_chunk, &job);
+}
+
+void grvx_propagate_missiles_f32(GrvxTrajectoryBatch batch,
+                                 uint32_t n,
+                                 GrvxPlanetsHandle planets,
+                                 double h,
+                                 uint32_t *n_steps,
+                                 int32_t *premature)
+{
+    propagate_lanes_f32(batch, n, planets, (float)h, n_steps, premature);
+}
+
+int grvx_interpolate_missile(const struct GrvxTrajectory *trj,
+                             uint32_t n,
+                             double h,
+                             double t,
+                             double *x,
+                             double *v)
+{
+    if (!(t >= 0. && t <= (double)n - 1.) || n > GRVX_TRAJECTORY_SIZE) {
+        return 1;
+    }
+
+    if (n == 1) {
+        for (unsigned c = 0; c < 3; c++) {
+            x[c] = trj->x[0][c];
+            v[c] = trj->v[0][c];
+        }
+        return 0;
+    }
+
+    // the last point is approached from the left
+    unsigned i = (unsigned)t;
+    i = i + 1 < n ? i : n - 2;
+
+    grvx_interpolate_on_sphere(trj->x[i],
+                               trj->v[i],
+                               trj->x[i + 1],
+                               trj->v[i + 1],
+                               GRVX_INT_STEPS * h,
+                               t - (double)i,
+                               x,
+                               v);
+    return 0;
+}
+
 double grvx_orb_period(double v, double h)
 {
     const double sin_threshold = sin(GRVX_MIN_DIST);
@@ -207,14 +516,34 @@ double grvx_orb_period(double v, double h)
         .p.z = v * cos_threshold,
     };
 
+    _Alignas(GRVX_PLANETS_ALIGNMENT) double x[GRVX_PLANETS_PADDING] = {0.};
+    _Alignas(GRVX_PLANETS_ALIGNMENT) double y[GRVX_PLANETS_PADDING] = {0.};
+    _Alignas(GRVX_PLANETS_ALIGNMENT) double z[GRVX_PLANETS_PADDING] = {0.};
+
+    // a single planet is never indexed spatially
+    struct GrvxPlanetsIndex index = {.theta = 0.,
+                                     .field_n = 0,
+                                     .built = false,
+                                     .tree_built = false,
+                                     .field_built = false,
+                                     .valid = false,
+                                     .tree_valid = false,
+                                     .field_valid = false,
+                                     .mutex = PTHREAD_MUTEX_INITIALIZER};
+
     struct GrvxPlanets p;
-    double planets_data[3];
-    p.data = planets_data;
+    p.x = x;
+    p.y = y;
+    p.z = z;
     p.n = 1;
+    p.index = &index;
 
     GrvxPlanetsHandle planets = &p;
     grvx_set_planet(planets, 0, 0., 0.);
 
+    // the planets are not created by grvx_new_planets()
+    grvx_init_pot();
+
     double mdist = -1.;
 
     struct GrvxQP qp2 = qp;
@@ -222,8 +551,7 @@ double grvx_orb_period(double v, double h)
     int t = 0;
     do {
         qp = qp2;
-        grvx_integration_step(&qp2, &e, h, planets);
-        mdist = grvx_min_dist(&qp2.q, planets);
+        mdist = grvx_integration_step(&qp2, &e, h, planets);
         t += 1;
     } while (mdist < cos_threshold);
 
@@ -245,10 +573,9 @@ void grvx_perturb_measurement(GrvxPlanetsHandle planets,
                               double *lat,
                               double *lon)
 {
-    const ptrdiff_t offset = 3 * (ptrdiff_t)planet;
-    const double x_p = planets->data[offset];
-    const double y_p = planets->data[offset + 1];
-    const double z_p = planets->data[offset + 2];
+    const double x_p = planets->x[planet];
+    const double y_p = planets->y[planet];
+    const double z_p = planets->z[planet];
     const double lat_p = grvx_lat(z_p);
     const double lon_p = grvx_lon(x_p, y_p);
 
@@ -1,65 +1,104 @@
 #include "libgravix2/observations.h"
+#include "libgravix2/stats.h"
+#include <stdbool.h>
 #include <stdlib.h>
 
-struct GrvxMissileObservations *
-add_observation(struct GrvxMissileObservations *head,
-                struct GrvxMissileObservation *obs)
+static bool before(const struct GrvxQueuedObservation *a,
+                   const struct GrvxQueuedObservation *b)
 {
-    struct GrvxMissileObservations *new_node =
-        malloc(sizeof(struct GrvxMissileObservations));
-    new_node->obs = obs;
-    new_node->next = 0;
+    return a->obs.t < b->obs.t || (a->obs.t == b->obs.t && a->seq < b->seq);
+}
 
-    if (head == 0) {
-        return new_node;
-    }
+void init_observations(struct GrvxMissileObservations *queue,
+                       unsigned capacity)
+{
+    queue->capacity = capacity > 0 ? capacity : 1;
+    queue->heap =
+        malloc(sizeof(struct GrvxQueuedObservation) * queue->capacity);
+    queue->size = 0;
+    queue->seq = 0;
+    queue->external = false;
+}
 
-    if (head->obs->t > obs->t) {
-        new_node->next = head;
-        return new_node;
+void init_observations_in(struct GrvxMissileObservations *queue,
+                          struct GrvxQueuedObservation *heap,
+                          unsigned capacity)
+{
+    queue->capacity = capacity;
+    queue->heap = heap;
+    queue->size = 0;
+    queue->seq = 0;
+    queue->external = true;
+}
+
+void add_observation(struct GrvxMissileObservations *queue,
+                     const struct GrvxMissileObservation *obs)
+{
+    if (queue->size == queue->capacity) {
+        queue->capacity *= 2;
+        queue->heap = realloc(queue->heap,
+                              sizeof(struct GrvxQueuedObservation) *
+                                  queue->capacity);
     }
 
-    struct GrvxMissileObservations *ptr = head;
-    while (ptr->next != 0) {
-        if (ptr->next->obs->t > obs->t) {
-            new_node->next = ptr->next;
-            ptr->next = new_node;
-            return head;
-        }
+    const struct GrvxQueuedObservation node = {*obs, queue->seq++};
+    GRVX_STATS_ADD(OBSERVATIONS_ADDED, 1);
 
-        ptr = ptr->next;
+    // sift up
+    unsigned i = queue->size++;
+    while (i > 0) {
+        const unsigned parent = (i - 1) / 2;
+        if (!before(&node, &queue->heap[parent])) {
+            break;
+        }
+        queue->heap[i] = queue->heap[parent];
+        i = parent;
     }
+    queue->heap[i] = node;
+}
 
-    ptr->next = new_node;
-    return head;
+const struct GrvxMissileObservation *
+peek_observation(const struct GrvxMissileObservations *queue)
+{
+    return queue->size > 0 ? &queue->heap[0].obs : 0;
 }
 
-struct GrvxMissileObservations *
-pop_observation(struct GrvxMissileObservations *head,
-                struct GrvxMissileObservation **observation)
+int pop_observation(struct GrvxMissileObservations *queue,
+                    struct GrvxMissileObservation *observation)
 {
-    if (head == 0) {
-        observation = 0;
-        return head;
+    if (queue->size == 0) {
+        return -1;
     }
 
-    *observation = head->obs;
+    *observation = queue->heap[0].obs;
+    GRVX_STATS_ADD(OBSERVATIONS_POPPED, 1);
 
-    struct GrvxMissileObservations *old = head;
-    head = old->next;
-    free(old);
+    // sift down the last element starting at the root
+    const struct GrvxQueuedObservation node = queue->heap[--queue->size];
+    const unsigned n = queue->size;
+    unsigned i = 0;
+    while (2 * i + 1 < n) {
+        unsigned child = 2 * i + 1;
+        if (child + 1 < n &&
+            before(&queue->heap[child + 1], &queue->heap[child])) {
+            child += 1;
+        }
+        if (!before(&queue->heap[child], &node)) {
+            break;
+        }
+        queue->heap[i] = queue->heap[child];
+        i = child;
+    }
+    if (n > 0) {
+        queue->heap[i] = node;
+    }
 
-    return head;
+    return 0;
 }
 
-void delete_observations(struct GrvxMissileObservations *head)
+void delete_observations(struct GrvxMissileObservations *queue)
 {
-    while (head != 0) {
-        free(head->obs);
-
-        struct GrvxMissileObservations *next = head->next;
-        free(head);
-
-        head = next;
+    if (!queue->external) {
+        free(queue->heap);
     }
 }
@@ -3,20 +3,62 @@
 #include <math.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "libgravix2/api.h"
+#include "libgravix2/constants.h"
+#include "libgravix2/pot.h"
+
+static double *new_coordinates(unsigned n)
+{
+    const size_t size = sizeof(double) * grvx_planets_padded(n > 0 ? n : 1);
+    double *ptr = aligned_alloc(GRVX_PLANETS_ALIGNMENT, size);
+    memset(ptr, 0, size);
+    return ptr;
+}
 
 GrvxPlanetsHandle grvx_new_planets(unsigned n)
 {
+    grvx_init_pot();
+
     struct GrvxPlanets *ptr = malloc(sizeof(struct GrvxPlanets));
-    ptr->data = malloc(sizeof(double) * 3 * n);
+    ptr->x = new_coordinates(n);
+    ptr->y = new_coordinates(n);
+    ptr->z = new_coordinates(n);
     ptr->n = n;
+
+    ptr->index = malloc(sizeof(struct GrvxPlanetsIndex));
+    ptr->index->theta = 0.;
+    ptr->index->field_n = 0;
+    ptr->index->field_r = 0.;
+    ptr->index->built = false;
+    ptr->index->tree_built = false;
+    ptr->index->field_built = false;
+    atomic_init(&ptr->index->valid, false);
+    atomic_init(&ptr->index->tree_valid, false);
+    atomic_init(&ptr->index->field_valid, false);
+    pthread_mutex_init(&ptr->index->mutex, NULL);
+
     return ptr;
 }
 
 void grvx_delete_planets(GrvxPlanetsHandle p)
 {
-    free(p->data);
+    if (p->index->built) {
+        grvx_spatial_index_free(&p->index->idx);
+    }
+    if (p->index->tree_built) {
+        grvx_tree_free(&p->index->tree);
+    }
+    if (p->index->field_built) {
+        grvx_field_free(&p->index->field);
+    }
+    pthread_mutex_destroy(&p->index->mutex);
+    free(p->index);
+
+    free(p->x);
+    free(p->y);
+    free(p->z);
     free(p);
 }
 
@@ -25,6 +67,13 @@ unsigned grvx_count_planets(GrvxPlanetsHandle p)
     return p->n;
 }
 
+static void invalidate(struct GrvxPlanets *p)
+{
+    atomic_store_explicit(&p->index->valid, false, memory_order_relaxed);
+    atomic_store_explicit(&p->index->tree_valid, false, memory_order_relaxed);
+    atomic_store_explicit(&p->index->field_valid, false, memory_order_relaxed);
+}
+
 int grvx_set_planet(GrvxPlanetsHandle p, unsigned i, double lat, double lon)
 {
     if (i >= p->n) {
@@ -36,10 +85,10 @@ int grvx_set_planet(GrvxPlanetsHandle p, unsigned i, double lat, double lon)
     const double sin_lon = sin(lon);
     const double cos_lon = cos(lon);
 
-    ptrdiff_t offset = 3 * (ptrdiff_t)i;
-    p->data[offset] = cos_lat * sin_lon;
-    p->data[offset + 1] = cos_lat * cos_lon;
-    p->data[offset + 2] = sin_lat;
+    p->x[i] = cos_lat * sin_lon;
+    p->y[i] = cos_lat * cos_lon;
+    p->z[i] = sin_lat;
+    invalidate(p);
 
     return 0;
 }
@@ -50,13 +99,38 @@ int grvx_get_planet(GrvxPlanetsHandle p, unsigned i, double *lat, double *lon)
         return -1;
     }
 
-    ptrdiff_t offset = 3 * (ptrdiff_t)i;
-    const double x = p->data[offset];
-    const double y = p->data[offset + 1];
-    const double z = p->data[offset + 2];
+    *lat = asin(p->z[i]);
+    *lon = atan2(p->x[i], p->y[i]);
+
+    return 0;
+}
+
+int grvx_set_planets(GrvxPlanetsHandle p,
+                     unsigned n,
+                     const double *lat,
+                     const double *lon)
+{
+    if (n > p->n) {
+        return -1;
+    }
+
+    for (unsigned i = 0; i < n; i++) {
+        grvx_set_planet(p, i, lat[i], lon[i]);
+    }
+
+    return 0;
+}
+
+int grvx_get_planets(GrvxPlanetsHandle p, unsigned n, double *lat, double *lon)
+{
+    if (n > p->n) {
+        return -1;
+    }
 
-    *lat = asin(z);
-    *lon = atan2(x, y);
+    for (unsigned i = 0; i < n; i++) {
+        lat[i] = asin(p->z[i]);
+        lon[i] = atan2(p->x[i], p->y[i]);
+    }
 
     return 0;
 }
@@ -65,6 +139,188 @@ unsigned grvx_pop_planet(GrvxPlanetsHandle p)
 {
     if (p->n > 0) {
         p->n = p->n - 1;
+
+        // removed planets become part of the (zero) padding
+        p->x[p->n] = 0.;
+        p->y[p->n] = 0.;
+        p->z[p->n] = 0.;
+        invalidate(p);
     }
     return p->n;
 }
+
+static double cell_size(unsigned n)
+{
+    // about two planets per cell
+    return sqrt(8. * M_PI / n);
+}
+
+static void rebuild_index(const struct GrvxPlanets *p)
+{
+    struct GrvxPlanetsIndex *index = p->index;
+    if (index->built) {
+        grvx_spatial_index_free(&index->idx);
+    }
+
+    grvx_spatial_index_init(&index->idx, p->n, cell_size(p->n));
+    for (unsigned i = 0; i < p->n; i++) {
+        const double x[3] = {p->x[i], p->y[i], p->z[i]};
+        grvx_spatial_index_insert(&index->idx, x);
+    }
+
+    index->built = true;
+    atomic_store_explicit(&index->valid, true, memory_order_release);
+}
+
+static void rebuild_tree(const struct GrvxPlanets *p)
+{
+    struct GrvxPlanetsIndex *index = p->index;
+    if (index->tree_built) {
+        grvx_tree_free(&index->tree);
+    }
+
+    grvx_tree_build(&index->tree, p->x, p->y, p->z, p->n, index->theta);
+
+    index->tree_built = true;
+    atomic_store_explicit(&index->tree_valid, true, memory_order_release);
+}
+
+static void rebuild_field(const struct GrvxPlanets *p,
+                          const struct GrvxTree *tree)
+{
+    struct GrvxPlanetsIndex *index = p->index;
+    if (index->field_built) {
+        grvx_field_free(&index->field);
+    }
+
+    grvx_field_init(&index->field,
+                    p->x,
+                    p->y,
+                    p->z,
+                    p->n,
+                    index->field_n,
+                    index->field_r);
+    grvx_sample_field(&index->field, p, tree);
+
+    index->field_built = true;
+    atomic_store_explicit(&index->field_valid, true, memory_order_release);
+}
+
+unsigned grvx_nearest_planet(const struct GrvxPlanets *planets,
+                             const double q[3],
+                             double *dot)
+{
+    const unsigned n = planets->n;
+    if (n == 0) {
+        return GRVX_SPATIAL_NONE;
+    }
+
+    if (n < GRVX_PLANETS_INDEX_THRESHOLD) {
+        unsigned id = 0;
+        double best = -2.;
+        for (unsigned i = 0; i < n; i++) {
+            const double d = q[0] * planets->x[i] + q[1] * planets->y[i] +
+                             q[2] * planets->z[i];
+            if (d > best) {
+                best = d;
+                id = i;
+            }
+        }
+
+        if (dot) {
+            *dot = best;
+        }
+        return id;
+    }
+
+    // double-checked locking, cf. grvx_planets_tree()
+    struct GrvxPlanetsIndex *index = planets->index;
+    if (!atomic_load_explicit(&index->valid, memory_order_acquire)) {
+        pthread_mutex_lock(&index->mutex);
+        if (!atomic_load_explicit(&index->valid, memory_order_relaxed)) {
+            rebuild_index(planets);
+        }
+        pthread_mutex_unlock(&index->mutex);
+    }
+
+    return grvx_spatial_index_nearest(&index->idx, q, cell_size(n), dot);
+}
+
+int grvx_closest_planet(GrvxPlanetsHandle p, double lat, double lon)
+{
+    const double cos_lat = cos(lat);
+    const double q[3] = {cos_lat * sin(lon), cos_lat * cos(lon), sin(lat)};
+
+    const unsigned id = grvx_nearest_planet(p, q, NULL);
+    return id == GRVX_SPATIAL_NONE ? -1 : (int)id;
+}
+
+const struct GrvxTree *grvx_planets_tree(const struct GrvxPlanets *planets)
+{
+    struct GrvxPlanetsIndex *index = planets->index;
+    if (index->theta == 0.) {
+        return NULL;
+    }
+
+    // up-to-date trees are shared by concurrent force evaluations w/o locking
+    if (!atomic_load_explicit(&index->tree_valid, memory_order_acquire)) {
+        pthread_mutex_lock(&index->mutex);
+        if (!atomic_load_explicit(&index->tree_valid, memory_order_relaxed)) {
+            rebuild_tree(planets);
+        }
+        pthread_mutex_unlock(&index->mutex);
+    }
+
+    return &index->tree;
+}
+
+int grvx_set_opening_angle(GrvxPlanetsHandle p, double theta)
+{
+    if (!(theta >= 0. && theta <= 1.)) {
+        return -1;
+    }
+
+    p->index->theta = theta;
+    invalidate(p);
+
+    return 0;
+}
+
+double grvx_get_opening_angle(GrvxPlanetsHandle p)
+{
+    return p->index->theta;
+}
+
+const struct GrvxField *grvx_planets_field(const struct GrvxPlanets *planets)
+{
+    struct GrvxPlanetsIndex *index = planets->index;
+    if (index->field_n == 0) {
+        return NULL;
+    }
+
+    if (!atomic_load_explicit(&index->field_valid, memory_order_acquire)) {
+        // the tree is guarded by the same mutex and thus (re)built beforehand
+        const struct GrvxTree *tree = grvx_planets_tree(planets);
+
+        pthread_mutex_lock(&index->mutex);
+        if (!atomic_load_explicit(&index->field_valid, memory_order_relaxed)) {
+            rebuild_field(planets, tree);
+        }
+        pthread_mutex_unlock(&index->mutex);
+    }
+
+    return &index->field;
+}
+
+int grvx_bake_field(GrvxPlanetsHandle p, unsigned resolution, double r_near)
+{
+    if (resolution > 0 && !(r_near >= GRVX_MIN_DIST && r_near < M_PI / 2.)) {
+        return -1;
+    }
+
+    p->index->field_n = resolution;
+    p->index->field_r = resolution > 0 ? r_near : 0.;
+    invalidate(p);
+
+    return 0;
+}
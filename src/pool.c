@@ -0,0 +1,246 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // pthread_setaffinity_np()
+#elif !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L // sysconf()
+#endif
+
+#include "libgravix2/pool.h"
+
+#include <sched.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "libgravix2/api.h"
+
+static uint64_t pack(uint32_t lo, uint32_t hi)
+{
+    return (uint64_t)lo << 32 | hi;
+}
+
+static uint32_t range_lo(uint64_t range)
+{
+    return (uint32_t)(range >> 32);
+}
+
+static uint32_t range_hi(uint64_t range)
+{
+    return (uint32_t)range;
+}
+
+static bool pop_chunk(struct GrvxPoolQueue *queue, uint32_t *chunk)
+{
+    uint64_t range = atomic_load(&queue->range);
+    for (;;) {
+        const uint32_t lo = range_lo(range);
+        const uint32_t hi = range_hi(range);
+        if (lo >= hi) {
+            return false;
+        }
+
+        // on failure, range is updated with the current value
+        if (atomic_compare_exchange_weak(
+                &queue->range, &range, pack(lo + 1, hi))) {
+            *chunk = lo;
+            return true;
+        }
+    }
+}
+
+static bool steal_chunks(struct GrvxPool *pool, unsigned id)
+{
+    const unsigned n = pool->n_threads;
+    for (unsigned k = 1; k < n; k++) {
+        struct GrvxPoolQueue *victim = &pool->queues[(id + k) % n];
+
+        uint64_t range = atomic_load(&victim->range);
+        for (;;) {
+            const uint32_t lo = range_lo(range);
+            const uint32_t hi = range_hi(range);
+            if (lo >= hi) {
+                break;
+            }
+
+            // steal the back half, rounded up
+            const uint32_t mid = hi - (hi - lo + 1) / 2;
+            if (atomic_compare_exchange_weak(
+                    &victim->range, &range, pack(lo, mid))) {
+                // own queue is empty and thus not touched by other thieves
+                atomic_store(&pool->queues[id].range, pack(mid, hi));
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static void work(struct GrvxPool *pool, unsigned id)
+{
+    struct GrvxPoolQueue *queue = &pool->queues[id];
+    const uint32_t n = pool->n;
+    const uint32_t size = pool->chunk;
+
+    for (;;) {
+        uint32_t chunk;
+        if (pop_chunk(queue, &chunk)) {
+            const uint32_t begin = chunk * size;
+            const uint32_t end = n - begin > size ? begin + size : n;
+            pool->task(pool->ctx, begin, end);
+        } else if (!steal_chunks(pool, id)) {
+            return;
+        }
+    }
+}
+
+static void *worker_main(void *arg)
+{
+    struct GrvxPoolWorker *worker = arg;
+    struct GrvxPool *pool = worker->pool;
+
+    uint64_t generation = 0;
+    pthread_mutex_lock(&pool->mutex);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == generation) {
+            pthread_cond_wait(&pool->wake, &pool->mutex);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        generation = pool->generation;
+        pthread_mutex_unlock(&pool->mutex);
+
+        work(pool, worker->id);
+
+        pthread_mutex_lock(&pool->mutex);
+        pool->n_busy -= 1;
+        if (pool->n_busy == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+static int pin_thread(pthread_t thread, int cpu)
+{
+#ifdef __linux__
+    if (cpu >= CPU_SETSIZE) {
+        return -1;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET((size_t)cpu, &set);
+    const int rc = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &set);
+    return rc == 0 ? 0 : -1;
+#else
+    // affinities are not supported on this platform
+    (void)thread;
+    (void)cpu;
+    return 0;
+#endif
+}
+
+void grvx_pool_run(struct GrvxPool *pool,
+                   uint32_t n,
+                   uint32_t chunk,
+                   GrvxPoolTask task,
+                   void *ctx)
+{
+    if (n == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->run_mutex);
+
+    const uint64_t n_chunks = (n + (uint64_t)chunk - 1) / chunk;
+    const unsigned n_threads = pool->n_threads;
+    for (unsigned i = 0; i < n_threads; i++) {
+        const uint32_t lo = (uint32_t)(i * n_chunks / n_threads);
+        const uint32_t hi = (uint32_t)((i + 1) * n_chunks / n_threads);
+        atomic_store(&pool->queues[i].range, pack(lo, hi));
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->task = task;
+    pool->ctx = ctx;
+    pool->n = n;
+    pool->chunk = chunk;
+    pool->n_busy = n_threads;
+    pool->generation += 1;
+    pthread_cond_broadcast(&pool->wake);
+
+    while (pool->n_busy > 0) {
+        pthread_cond_wait(&pool->done, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    pthread_mutex_unlock(&pool->run_mutex);
+}
+
+GrvxPoolHandle grvx_new_pool(unsigned n_threads, const int *cpus)
+{
+    if (n_threads == 0) {
+        const long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        n_threads = n_cpus > 0 ? (unsigned)n_cpus : 1;
+    }
+
+    struct GrvxPool *pool = malloc(sizeof(struct GrvxPool));
+    pool->n_threads = 0;
+    pool->workers = malloc(sizeof(struct GrvxPoolWorker) * n_threads);
+    pool->queues = aligned_alloc(GRVX_POOL_ALIGNMENT,
+                                 sizeof(struct GrvxPoolQueue) * n_threads);
+    pthread_mutex_init(&pool->run_mutex, NULL);
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->generation = 0;
+    pool->n_busy = 0;
+    pool->shutdown = false;
+
+    for (unsigned i = 0; i < n_threads; i++) {
+        atomic_init(&pool->queues[i].range, 0);
+
+        struct GrvxPoolWorker *worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->id = i;
+        if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0) {
+            grvx_delete_pool(pool);
+            return NULL;
+        }
+        pool->n_threads += 1;
+
+        if (cpus && cpus[i] >= 0 && pin_thread(worker->thread, cpus[i]) != 0) {
+            grvx_delete_pool(pool);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+void grvx_delete_pool(GrvxPoolHandle pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (unsigned i = 0; i < pool->n_threads; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_mutex_destroy(&pool->run_mutex);
+    free(pool->queues);
+    free(pool->workers);
+    free(pool);
+}
+
+unsigned grvx_count_threads(GrvxPoolHandle pool)
+{
+    return pool->n_threads;
+}
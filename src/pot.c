@@ -1,25 +1,34 @@
 #include "libgravix2/pot.h"
 
 #include <math.h>
+#include <stdbool.h>
 #include <stddef.h>
 
 #include "libgravix2/api.h"
 #include "libgravix2/config.h"
+#include "libgravix2/constants.h"
+#include "libgravix2/field.h"
 #include "libgravix2/linalg.h"
 #include "libgravix2/planet.h"
+#include "libgravix2/spatial.h"
+#include "libgravix2/stats.h"
 
 #if GRVX_POT_TYPE == GRVX_POT_TYPE_3D
-#include "libgravix2/constants.h"
 #include "libgravix2/helpers.h"
+#if GRVX_POT_TABLE_SIZE > 0
+#include <pthread.h>
+#endif
 #endif
 
 #if GRVX_POT_TYPE == GRVX_POT_TYPE_3D
 
-static double pot3D_approx(double x)
+#if GRVX_N_POT > 0
+
+static double pot3D(double x)
 {
     const double TWO_PI = 2. * M_PI;
 
-    // TODO: use lookup table and cubic hermite spline
+    // evaluated only once per escape velocity and thus not tabulated
     double acc = 0.;
 
     // accumulate contributions starting with the smallest one
@@ -31,9 +40,8 @@ static double pot3D_approx(double x)
     return acc / (2. * TWO_PI);
 }
 
-static double f3D_approx(double x)
+static double f3D(double x)
 {
-    // TODO: use lookup table and cubic hermite spline
     double acc = 0.;
 
     // accumulate contributions starting with the smallest one
@@ -45,60 +53,711 @@ static double f3D_approx(double x)
     return -acc / grvx_sinc(x);
 }
 
+#else
+
+/*
+ * Infinite order, i.e., GRVX_N_POT = 0: with c_j = j + 1/2 both series can be
+ * written as sums over rational functions of c_j and of y with |y| <= 1/2,
+ *
+ *   V_3D = 1/(4 pi^2) sum_j y^2 / (c_j (c_j^2 - y^2)),
+ *   F_3D ~ 1/(8 pi^4) sum_j c_j / (c_j^2 - y^2)^2.
+ *
+ * The first N_DIRECT terms are summed explicitly. The remaining terms are
+ * expanded in y^2 / c_j^2 <= 1/25 and resummed, which yields power series in
+ * y^2 whose coefficients are Hurwitz zeta values
+ *
+ *   HURWITZ_ZETA[m] = zeta(2m + 3, N_DIRECT + 1/2)
+ *                   = sum_{j >= N_DIRECT} c_j^-(2m + 3).
+ *
+ * Truncating after N_TAIL coefficients gives relative errors below 1e-14.
+ */
+#define N_DIRECT 2
+#define N_TAIL 9
+
+static const double HURWITZ_ZETA[N_TAIL] = {
+    1.18102025820863696e-01, 1.30731666461138072e-02, 1.83056403826393783e-03,
+    2.76439254262647138e-04, 4.30526886555426054e-05, 6.79892923197479440e-06,
+    1.08081161934498741e-06, 1.72370261444419945e-07, 2.75341824012745253e-08,
+};
+
+static double pot3D(double x)
+{
+    const double y = x / (2. * M_PI) - .5;
+    const double y2 = y * y;
+
+    double tail = 0.;
+    for (unsigned m = N_TAIL; m-- > 0;) {
+        tail = tail * y2 + HURWITZ_ZETA[m];
+    }
+
+    double acc = tail * y2;
+    for (unsigned j = N_DIRECT; j-- > 0;) {
+        const double c = j + .5;
+        acc += y2 / (c * (c * c - y2));
+    }
+
+    return acc / (4. * M_PI * M_PI);
+}
+
+static double f3D(double x)
+{
+    const double y = x / (2. * M_PI);
+    const double y2 = y * y;
+
+    double tail = 0.;
+    for (unsigned m = N_TAIL; m-- > 0;) {
+        tail = tail * y2 + (m + 1) * HURWITZ_ZETA[m];
+    }
+
+    double acc = tail;
+    for (unsigned j = N_DIRECT; j-- > 0;) {
+        const double c = j + .5;
+        const double r = c * c - y2;
+        acc += c / (r * r);
+    }
+
+    const double PI2 = M_PI * M_PI;
+    return -acc / (8. * PI2 * PI2 * grvx_sinc(x));
+}
+
+#undef N_DIRECT
+#undef N_TAIL
+
 #endif
 
-void grvx_gradV(struct GrvxVec3D *x, const struct GrvxPlanets *planets)
+#if GRVX_POT_TABLE_SIZE > 0
+
+/*
+ * The force is tabulated as a function of s = sin(r/2) = sqrt((1 - d) / 2),
+ * where r is the angular distance and d = cos(r). The singularity at s = 0 is
+ * factored out, i.e., we store the smooth function G(s) = s^3 f3D(r - pi),
+ * which varies by less than 10% over [0, 1], together with its derivative
+ * and recover the force as G(s) / s^3. With 256 intervals and cubic Hermite
+ * interpolation the relative error w.r.t. f3D is below 1e-11.
+ */
+struct TableNode {
+    double g;
+    double dg;
+};
+
+static struct TableNode table[GRVX_POT_TABLE_SIZE + 1];
+static pthread_once_t table_once = PTHREAD_ONCE_INIT;
+
+static double table_g(double s)
 {
-    struct GrvxVec3D acc = {0., 0., 0.};
+    if (s <= 0.) {
+        // lim_{s -> 0} s^3 f3D(2 asin(s) - pi)
+        return -1. / (32. * M_PI);
+    }
 
-    const ptrdiff_t N = (ptrdiff_t)planets->n;
-    for (ptrdiff_t i = 0; i < N; i++) {
-        struct GrvxVec3D planet = {
-            planets->data[3 * i],
-            planets->data[3 * i + 1],
-            planets->data[3 * i + 2],
-        };
-        const double d = grvx_dot(*x, planet);
+    const double s_max = s < 1. ? s : 1.;
+    return s_max * s_max * s_max * f3D(2. * asin(s_max) - M_PI);
+}
+
+static double table_dg(double s)
+{
+    // five-point stencils, one-sided at the boundaries of [0, 1]
+    const double H = 1e-3;
+    if (s < 2. * H) {
+        return (-25. * table_g(s) + 48. * table_g(s + H) -
+                36. * table_g(s + 2. * H) + 16. * table_g(s + 3. * H) -
+                3. * table_g(s + 4. * H)) /
+               (12. * H);
+    }
+    if (s > 1. - 2. * H) {
+        return (25. * table_g(s) - 48. * table_g(s - H) +
+                36. * table_g(s - 2. * H) - 16. * table_g(s - 3. * H) +
+                3. * table_g(s - 4. * H)) /
+               (12. * H);
+    }
+    return (table_g(s - 2. * H) - 8. * table_g(s - H) + 8. * table_g(s + H) -
+            table_g(s + 2. * H)) /
+           (12. * H);
+}
+
+static void init_table(void)
+{
+    for (unsigned i = 0; i <= GRVX_POT_TABLE_SIZE; i++) {
+        const double s = (double)i / GRVX_POT_TABLE_SIZE;
+        table[i].g = table_g(s);
+        table[i].dg = table_dg(s);
+    }
+}
+
+static inline double f3D_table(double d)
+{
+    double s = sqrt(.5 * (1. - d));
+    s = s < 1. ? s : 1.;
+
+    const double u = s * GRVX_POT_TABLE_SIZE;
+    unsigned i = (unsigned)u;
+    i = i < GRVX_POT_TABLE_SIZE ? i : GRVX_POT_TABLE_SIZE - 1;
+
+    const double t = u - (double)i;
+    const double t2 = t * t;
+    const double t3 = t2 * t;
+    const double h = 1. / GRVX_POT_TABLE_SIZE;
+
+    const double g = (2. * t3 - 3. * t2 + 1.) * table[i].g +
+                     (t3 - 2. * t2 + t) * h * table[i].dg +
+                     (3. * t2 - 2. * t3) * table[i + 1].g +
+                     (t3 - t2) * h * table[i + 1].dg;
+
+    return g / (s * s * s);
+}
+
+#endif
+
+#endif
+
+void grvx_init_pot(void)
+{
+#if GRVX_POT_TYPE == GRVX_POT_TYPE_3D && GRVX_POT_TABLE_SIZE > 0
+    pthread_once(&table_once, init_table);
+#endif
+}
+
+static inline double force(double d)
+{
+#if GRVX_POT_TYPE == GRVX_POT_TYPE_2D
+    return -1. / (1. - d);
+#elif GRVX_POT_TYPE == GRVX_POT_TYPE_3D
+#if GRVX_POT_TABLE_SIZE > 0
+    return f3D_table(d);
+#else
+    return f3D(acos(d) - M_PI);
+#endif
+#endif
+}
 
+static inline float force_f32(float d)
+{
 #if GRVX_POT_TYPE == GRVX_POT_TYPE_2D
-        const double s = -1. / (1. - d);
+    return -1.f / (1.f - d);
 #elif GRVX_POT_TYPE == GRVX_POT_TYPE_3D
-        const double s = f3D_approx(acos(d) - M_PI);
+    return (float)force((double)d);
 #endif
+}
+
+/*
+ * Barnes-Hut traversal of the tree in pre-order: Far clusters contribute via
+ * their pseudo-planets and are skipped together with their descendants, leaves
+ * that are too close are summed exactly, and all other clusters are opened.
+ */
+static void gradV_tree(struct GrvxVec3D *x, const struct GrvxTree *tree)
+{
+    const double q[3] = {x->x, x->y, x->z};
+    double acc[3] = {0., 0., 0.};
+    unsigned n_terms = 0;
+
+    unsigned i = 0;
+    while (i < tree->n_nodes) {
+        const struct GrvxTreeNode *node = &tree->nodes[i];
+        const double d = q[0] * node->c[0] + q[1] * node->c[1] +
+                         q[2] * node->c[2];
+
+        if (d < node->cos_open) {
+            for (unsigned k = 0; k < GRVX_TREE_PSEUDO; k++) {
+                const double *xk = node->x[k];
+                const double dk = q[0] * xk[0] + q[1] * xk[1] + q[2] * xk[2];
+                const double s = node->w[k] * force(dk);
+                acc[0] += s * xk[0];
+                acc[1] += s * xk[1];
+                acc[2] += s * xk[2];
+            }
+            n_terms += GRVX_TREE_PSEUDO;
+            i = node->skip;
+        } else if (node->skip == i + 1) {
+            for (unsigned k = node->begin; k < node->end; k++) {
+                const double dk = q[0] * tree->x[k] + q[1] * tree->y[k] +
+                                  q[2] * tree->z[k];
+                const double s = force(dk);
+                acc[0] += s * tree->x[k];
+                acc[1] += s * tree->y[k];
+                acc[2] += s * tree->z[k];
+            }
+            n_terms += node->end - node->begin;
+            i = node->skip;
+        } else {
+            i += 1;
+        }
+    }
+    GRVX_STATS_ADD(INTERACTIONS, n_terms);
+
+    x->x = acc[0];
+    x->y = acc[1];
+    x->z = acc[2];
+}
+
+/*
+ * Near parts of the forces of all planets in the bin of q, cf. GrvxField.
+ */
+static void near_field(const double q[3],
+                       const struct GrvxField *field,
+                       unsigned bin,
+                       double acc[3])
+{
+    for (unsigned k = field->bin_start[bin]; k < field->bin_start[bin + 1];
+         k++) {
+        const double d = q[0] * field->x[k] + q[1] * field->y[k] +
+                         q[2] * field->z[k];
+        if (d > field->cos_near) {
+            const double w = 1. - grvx_field_far_weight(field, d);
+            const double s = w * force(d);
+            acc[0] += s * field->x[k];
+            acc[1] += s * field->y[k];
+            acc[2] += s * field->z[k];
+        }
+    }
+}
+
+static void gradV_field(struct GrvxVec3D *x, const struct GrvxField *field)
+{
+    const double q[3] = {x->x, x->y, x->z};
+    const struct GrvxFieldCoord coord = grvx_field_locate(q);
+
+    double acc[3];
+    grvx_field_interpolate(field, coord, acc);
+    const unsigned bin = grvx_field_bin(field, coord);
+    near_field(q, field, bin, acc);
+    GRVX_STATS_ADD(INTERACTIONS,
+                   field->bin_start[bin + 1] - field->bin_start[bin]);
+
+    x->x = acc[0];
+    x->y = acc[1];
+    x->z = acc[2];
+}
+
+static inline double gradV_min_dist_direct(struct GrvxVec3D *x,
+                                           const struct GrvxPlanets *planets,
+                                           bool with_min_dist)
+{
+    const double *restrict px = planets->x;
+    const double *restrict py = planets->y;
+    const double *restrict pz = planets->z;
 
-        acc.x += s * planet.x;
-        acc.y += s * planet.y;
-        acc.z += s * planet.z;
+    // independent accumulators for each lane allow for vectorization w/o
+    // reassociating the floating point additions
+    double acc_x[GRVX_SIMD_LANES] = {0.};
+    double acc_y[GRVX_SIMD_LANES] = {0.};
+    double acc_z[GRVX_SIMD_LANES] = {0.};
+    double mdist_l[GRVX_SIMD_LANES];
+    for (unsigned l = 0; l < GRVX_SIMD_LANES; l++) {
+        mdist_l[l] = -1.;
+    }
+
+    const ptrdiff_t N = (ptrdiff_t)planets->n;
+    const ptrdiff_t N_LANES = N - N % GRVX_SIMD_LANES;
+
+    ptrdiff_t i = 0;
+    for (; i < N_LANES; i += GRVX_SIMD_LANES) {
+        for (unsigned l = 0; l < GRVX_SIMD_LANES; l++) {
+            const double d = x->x * px[i + l] + x->y * py[i + l] +
+                             x->z * pz[i + l];
+            const double s = force(d);
+
+            acc_x[l] += s * px[i + l];
+            acc_y[l] += s * py[i + l];
+            acc_z[l] += s * pz[i + l];
+            if (with_min_dist) {
+                mdist_l[l] = d > mdist_l[l] ? d : mdist_l[l];
+            }
+        }
+    }
+
+    // remaining planets are not padded in order to not waste expensive force
+    // evaluations (e.g., for V_3D) on zero vectors
+    for (unsigned l = 0; i < N; i++, l++) {
+        const double d = x->x * px[i] + x->y * py[i] + x->z * pz[i];
+        const double s = force(d);
+
+        acc_x[l] += s * px[i];
+        acc_y[l] += s * py[i];
+        acc_z[l] += s * pz[i];
+        if (with_min_dist) {
+            mdist_l[l] = d > mdist_l[l] ? d : mdist_l[l];
+        }
+    }
+
+    struct GrvxVec3D acc = {0., 0., 0.};
+    double mdist = -1.;
+    for (unsigned l = 0; l < GRVX_SIMD_LANES; l++) {
+        acc.x += acc_x[l];
+        acc.y += acc_y[l];
+        acc.z += acc_z[l];
+        mdist = mdist_l[l] > mdist ? mdist_l[l] : mdist;
     }
 
     *x = acc;
+    return mdist;
+}
+
+static inline double gradV_min_dist(struct GrvxVec3D *x,
+                                    const struct GrvxPlanets *planets,
+                                    bool with_min_dist)
+{
+    GRVX_STATS_ADD(FORCE_EVALUATIONS, 1);
+
+    // approximations do not visit all planets close to x, cf.
+    // grvx_gradV_min_dist()
+    const struct GrvxField *field = grvx_planets_field(planets);
+    if (field) {
+        gradV_field(x, field);
+        return 1.;
+    }
+
+    const struct GrvxTree *tree = grvx_planets_tree(planets);
+    if (tree) {
+        gradV_tree(x, tree);
+        return 1.;
+    }
+
+    GRVX_STATS_ADD(INTERACTIONS, planets->n);
+    return gradV_min_dist_direct(x, planets, with_min_dist);
+}
+
+void grvx_gradV(struct GrvxVec3D *x, const struct GrvxPlanets *planets)
+{
+    gradV_min_dist(x, planets, false);
+}
+
+double grvx_gradV_min_dist(struct GrvxVec3D *x,
+                           const struct GrvxPlanets *planets)
+{
+    return gradV_min_dist(x, planets, true);
 }
 
 double grvx_min_dist(const struct GrvxVec3D *x,
                      const struct GrvxPlanets *planets)
 {
-    double mdist = -1.;
+    // large sets of planets are indexed spatially
+    if (planets->n >= GRVX_PLANETS_INDEX_THRESHOLD) {
+        const double q[3] = {x->x, x->y, x->z};
+        double mdist;
+        grvx_nearest_planet(planets, q, &mdist);
+        return mdist;
+    }
 
+    const double *restrict px = planets->x;
+    const double *restrict py = planets->y;
+    const double *restrict pz = planets->z;
+
+    double mdist_l[GRVX_SIMD_LANES];
+    for (unsigned l = 0; l < GRVX_SIMD_LANES; l++) {
+        mdist_l[l] = -1.;
+    }
+
+    // padding elements must not be taken into account here
     const ptrdiff_t N = (ptrdiff_t)planets->n;
-    for (ptrdiff_t i = 0; i < N; i++) {
-        struct GrvxVec3D planet = {
-            planets->data[3 * i],
-            planets->data[3 * i + 1],
-            planets->data[3 * i + 2],
-        };
-        const double d = grvx_dot(*x, planet);
+    const ptrdiff_t N_LANES = N - N % GRVX_SIMD_LANES;
+
+    ptrdiff_t i = 0;
+    for (; i < N_LANES; i += GRVX_SIMD_LANES) {
+        for (unsigned l = 0; l < GRVX_SIMD_LANES; l++) {
+            const double d = x->x * px[i + l] + x->y * py[i + l] +
+                             x->z * pz[i + l];
+            mdist_l[l] = d > mdist_l[l] ? d : mdist_l[l];
+        }
+    }
+
+    double mdist = -1.;
+    for (unsigned l = 0; l < GRVX_SIMD_LANES; l++) {
+        mdist = mdist_l[l] > mdist ? mdist_l[l] : mdist;
+    }
+
+    for (; i < N; i++) {
+        const double d = x->x * px[i] + x->y * py[i] + x->z * pz[i];
         mdist = d > mdist ? d : mdist;
     }
 
     return mdist;
 }
 
+void grvx_gradV_min_dist_lanes(struct GrvxVec3DLanes *x,
+                               const struct GrvxPlanets *planets,
+                               double *mdist)
+{
+    GRVX_STATS_ADD(FORCE_EVALUATIONS, GRVX_SIMD_LANES);
+
+    const struct GrvxField *field = grvx_planets_field(planets);
+    if (field) {
+        for (unsigned l = 0; l < GRVX_SIMD_LANES; l++) {
+            struct GrvxVec3D q = {x->x[l], x->y[l], x->z[l]};
+            gradV_field(&q, field);
+            mdist[l] = 1.;
+            x->x[l] = q.x;
+            x->y[l] = q.y;
+            x->z[l] = q.z;
+        }
+        return;
+    }
+
+    const struct GrvxTree *tree = grvx_planets_tree(planets);
+    if (tree) {
+        for (unsigned l = 0; l < GRVX_SIMD_LANES; l++) {
+            struct GrvxVec3D q = {x->x[l], x->y[l], x->z[l]};
+            gradV_tree(&q, tree);
+            mdist[l] = 1.;
+            x->x[l] = q.x;
+            x->y[l] = q.y;
+            x->z[l] = q.z;
+        }
+        return;
+    }
+
+    struct GrvxVec3DLanes acc = {{0.}, {0.}, {0.}};
+    for (unsigned l = 0; l < GRVX_SIMD_LANES; l++) {
+        mdist[l] = -1.;
+    }
+    GRVX_STATS_ADD(INTERACTIONS, (uint64_t)planets->n * GRVX_SIMD_LANES);
+
+    const ptrdiff_t N = (ptrdiff_t)planets->n;
+    for (ptrdiff_t i = 0; i < N; i++) {
+        const double px = planets->x[i];
+        const double py = planets->y[i];
+        const double pz = planets->z[i];
+
+        for (unsigned l = 0; l < GRVX_SIMD_LANES; l++) {
+            const double d = x->x[l] * px + x->y[l] * py + x->z[l] * pz;
+            const double s = force(d);
+
+            acc.x[l] += s * px;
+            acc.y[l] += s * py;
+            acc.z[l] += s * pz;
+            mdist[l] = d > mdist[l] ? d : mdist[l];
+        }
+    }
+
+    *x = acc;
+}
+
+void grvx_gradV_min_dist_lanes_f32(struct GrvxVec3DLanesF32 *x,
+                                   const struct GrvxPlanets *planets,
+                                   float *mdist)
+{
+    GRVX_STATS_ADD(FORCE_EVALUATIONS, GRVX_SIMD_LANES_F32);
+
+    const struct GrvxField *field = grvx_planets_field(planets);
+    if (field) {
+        for (unsigned l = 0; l < GRVX_SIMD_LANES_F32; l++) {
+            struct GrvxVec3D q = {x->x[l], x->y[l], x->z[l]};
+            gradV_field(&q, field);
+            mdist[l] = 1.f;
+            x->x[l] = (float)q.x;
+            x->y[l] = (float)q.y;
+            x->z[l] = (float)q.z;
+        }
+        return;
+    }
+
+    const struct GrvxTree *tree = grvx_planets_tree(planets);
+    if (tree) {
+        for (unsigned l = 0; l < GRVX_SIMD_LANES_F32; l++) {
+            struct GrvxVec3D q = {x->x[l], x->y[l], x->z[l]};
+            gradV_tree(&q, tree);
+            mdist[l] = 1.f;
+            x->x[l] = (float)q.x;
+            x->y[l] = (float)q.y;
+            x->z[l] = (float)q.z;
+        }
+        return;
+    }
+
+    // local copies do not alias with planets and thus allow for vectorization
+    const struct GrvxVec3DLanesF32 q = *x;
+    struct GrvxVec3DLanesF32 acc = {{0.f}, {0.f}, {0.f}};
+    float mdist_l[GRVX_SIMD_LANES_F32];
+    for (unsigned l = 0; l < GRVX_SIMD_LANES_F32; l++) {
+        mdist_l[l] = -1.f;
+    }
+    GRVX_STATS_ADD(INTERACTIONS, (uint64_t)planets->n * GRVX_SIMD_LANES_F32);
+
+    const ptrdiff_t N = (ptrdiff_t)planets->n;
+    for (ptrdiff_t i = 0; i < N; i++) {
+        const float px = (float)planets->x[i];
+        const float py = (float)planets->y[i];
+        const float pz = (float)planets->z[i];
+
+        // complete unrolling at -O3 defeats the loop vectorizer here
+#pragma GCC unroll 1
+        for (unsigned l = 0; l < GRVX_SIMD_LANES_F32; l++) {
+            const float d = q.x[l] * px + q.y[l] * py + q.z[l] * pz;
+            const float s = force_f32(d);
+
+            acc.x[l] += s * px;
+            acc.y[l] += s * py;
+            acc.z[l] += s * pz;
+            mdist_l[l] = d > mdist_l[l] ? d : mdist_l[l];
+        }
+    }
+
+    *x = acc;
+    for (unsigned l = 0; l < GRVX_SIMD_LANES_F32; l++) {
+        mdist[l] = mdist_l[l];
+    }
+}
+
+/*
+ * Far parts of the forces of all planets, cf. GrvxField. Planets at the
+ * position q do not contribute, which avoids evaluating the singular force.
+ */
+static void far_field_direct(const double q[3],
+                             const struct GrvxPlanets *planets,
+                             const struct GrvxField *field,
+                             double acc[3])
+{
+    for (unsigned i = 0; i < planets->n; i++) {
+        const double d =
+            q[0] * planets->x[i] + q[1] * planets->y[i] + q[2] * planets->z[i];
+        const double w = grvx_field_far_weight(field, d);
+        const double s = w > 0. ? w * force(d) : 0.;
+        acc[0] += s * planets->x[i];
+        acc[1] += s * planets->y[i];
+        acc[2] += s * planets->z[i];
+    }
+}
+
+/*
+ * Same as far_field_direct() but traverses the tree, cf. gradV_tree().
+ * Clusters that overlap with the near field of q are always opened s.t. the
+ * weights are applied to single planets only.
+ */
+static void far_field_tree(const double q[3],
+                           const struct GrvxTree *tree,
+                           const struct GrvxField *field,
+                           double acc[3])
+{
+    unsigned i = 0;
+    while (i < tree->n_nodes) {
+        const struct GrvxTreeNode *node = &tree->nodes[i];
+        const double d = q[0] * node->c[0] + q[1] * node->c[1] +
+                         q[2] * node->c[2];
+
+        if (d < node->cos_open &&
+            acos(d > -1. ? d : -1.) > node->rho + field->r_near) {
+            for (unsigned k = 0; k < GRVX_TREE_PSEUDO; k++) {
+                const double *xk = node->x[k];
+                const double dk = q[0] * xk[0] + q[1] * xk[1] + q[2] * xk[2];
+                const double s = node->w[k] * force(dk);
+                acc[0] += s * xk[0];
+                acc[1] += s * xk[1];
+                acc[2] += s * xk[2];
+            }
+            i = node->skip;
+        } else if (node->skip == i + 1) {
+            for (unsigned k = node->begin; k < node->end; k++) {
+                const double dk = q[0] * tree->x[k] + q[1] * tree->y[k] +
+                                  q[2] * tree->z[k];
+                const double w = grvx_field_far_weight(field, dk);
+                const double s = w > 0. ? w * force(dk) : 0.;
+                acc[0] += s * tree->x[k];
+                acc[1] += s * tree->y[k];
+                acc[2] += s * tree->z[k];
+            }
+            i = node->skip;
+        } else {
+            i += 1;
+        }
+    }
+}
+
+void grvx_sample_field(struct GrvxField *field,
+                       const struct GrvxPlanets *planets,
+                       const struct GrvxTree *tree)
+{
+    grvx_init_pot();
+
+    const unsigned n_nodes = grvx_field_size(field);
+    for (unsigned k = 0; k < n_nodes; k++) {
+        double q[3];
+        grvx_field_node(field, k, q);
+
+        double far[3] = {0., 0., 0.};
+        if (tree) {
+            far_field_tree(q, tree, field, far);
+        } else {
+            far_field_direct(q, planets, field, far);
+        }
+
+        // only the tangential components affect the motion of missiles
+        const double radial = q[0] * far[0] + q[1] * far[1] + q[2] * far[2];
+        for (unsigned j = 0; j < 3; j++) {
+            field->f[3 * k + j] = far[j] - radial * q[j];
+        }
+    }
+}
+
+double grvx_field_error(GrvxPlanetsHandle planets, unsigned n_samples)
+{
+    grvx_init_pot();
+
+    // Fibonacci lattice, i.e., equidistant heights and golden angle rotations
+    const double golden_angle = M_PI * (3. - sqrt(5.));
+
+    double err2 = 0.;
+    double norm2 = 0.;
+    for (unsigned i = 0; i < n_samples; i++) {
+        const double z = 1. - (2. * i + 1.) / n_samples;
+        const double r = sqrt(1. - z * z);
+        const double phi = golden_angle * i;
+        const struct GrvxVec3D q = {r * cos(phi), r * sin(phi), z};
+
+        struct GrvxVec3D f = q;
+        gradV_min_dist(&f, planets, false);
+        struct GrvxVec3D f0 = q;
+        gradV_min_dist_direct(&f0, planets, false);
+
+        // radial components are irrelevant, cf. grvx_sample_field()
+        const struct GrvxVec3D df = {f.x - f0.x, f.y - f0.y, f.z - f0.z};
+        const double df_q = grvx_dot(df, q);
+        const double f0_q = grvx_dot(f0, q);
+        const struct GrvxVec3D dt = {
+            df.x - df_q * q.x, df.y - df_q * q.y, df.z - df_q * q.z};
+        const struct GrvxVec3D ft = {
+            f0.x - f0_q * q.x, f0.y - f0_q * q.y, f0.z - f0_q * q.z};
+
+        err2 += grvx_dot(dt, dt);
+        norm2 += grvx_dot(ft, ft);
+    }
+
+    return norm2 > 0. ? sqrt(err2 / norm2) : 0.;
+}
+
+double grvx_step_control(const struct GrvxVec3D *q,
+                         const struct GrvxVec3D *p,
+                         const struct GrvxPlanets *planets,
+                         double *dlog_sigma)
+{
+    // only the nearest planet is taken into account s.t. sigma ~ 1 far from
+    // planets, independent of their number
+    const double x[3] = {q->x, q->y, q->z};
+    double d;
+    const unsigned i = grvx_nearest_planet(planets, x, &d);
+    if (i == GRVX_SPATIAL_NONE) {
+        *dlog_sigma = 0.;
+        return 1.;
+    }
+
+    const double dd =
+        p->x * planets->x[i] + p->y * planets->y[i] + p->z * planets->z[i];
+    const double r = 1. / (1. - d);
+
+    // sigma^-2 = 1 + c / (1 - d), where c = 1 - cos(r_c) s.t. a planet at
+    // distance r << r_c yields sigma ~ r / r_c
+    const double r_c = GRVX_STEP_CONTROL_RANGE * GRVX_MIN_DIST;
+    const double c = 2. * pow(sin(r_c / 2.), 2);
+    const double u = 1. + c * r;
+
+    *dlog_sigma = -.5 * c * dd * r * r / u;
+    return 1. / sqrt(u);
+}
+
 double grvx_v_esc(void)
 {
 #if GRVX_POT_TYPE == GRVX_POT_TYPE_2D
     const double pot = -2. * log(sin(GRVX_MIN_DIST / 2.));
 #elif GRVX_POT_TYPE == GRVX_POT_TYPE_3D
-    const double pot = pot3D_approx(GRVX_MIN_DIST);
+    const double pot = pot3D(GRVX_MIN_DIST);
 #endif
 
     return sqrt(2. * pot);
@@ -109,6 +768,8 @@ double grvx_v_scrcl(double r)
 #if GRVX_POT_TYPE == GRVX_POT_TYPE_2D
     return sqrt((1. + cos(r)) / fabs(cos(r)));
 #elif GRVX_POT_TYPE == GRVX_POT_TYPE_3D
-    return sin(r) * sqrt(-f3D_approx(r - M_PI) / fabs(cos(r)));
+    // use the same (possibly tabulated) force as the integrator
+    grvx_init_pot();
+    return sin(r) * sqrt(-force(cos(r)) / fabs(cos(r)));
 #endif
 }
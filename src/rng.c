@@ -0,0 +1,40 @@
+#include "libgravix2/game.h"
+
+// increment of the state of SplitMix64 (golden ratio)
+#define GAMMA 0x9e3779b97f4a7c15ULL
+
+/*
+ * Output function of SplitMix64 (Steele, Lea, and Flood 2014), which is a
+ * bijective mixer of 64 bit words.
+ */
+static uint64_t mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+struct GrvxRng grvx_init_rng(uint64_t seed)
+{
+    struct GrvxRng rng = {mix(seed), 0U};
+    return rng;
+}
+
+struct GrvxRng grvx_split_rng(const struct GrvxRng *rng, uint64_t stream)
+{
+    // the second mix decorrelates children of neighboring streams and keys
+    struct GrvxRng child = {mix(rng->key ^ mix(stream + GAMMA)), 0U};
+    return child;
+}
+
+uint64_t grvx_rng_next(struct GrvxRng *rng)
+{
+    // SplitMix64 at the state key + (counter + 1) * GAMMA
+    rng->counter += 1;
+    return mix(rng->key + rng->counter * GAMMA);
+}
+
+double grvx_rng_uniform(struct GrvxRng *rng)
+{
+    return (double)(grvx_rng_next(rng) >> 11) * 0x1.0p-53;
+}
@@ -0,0 +1,170 @@
+#include "libgravix2/spatial.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "libgravix2/constants.h"
+
+// widens all caps to guard against round-off errors of the cell assignment
+#define MARGIN 1e-9
+
+static double clamp(double x, double lo, double hi)
+{
+    return x < lo ? lo : x > hi ? hi : x;
+}
+
+static unsigned ring_of(const struct GrvxSpatialIndex *idx, double lat)
+{
+    const double j = floor((lat + M_PI / 2.) / idx->ring_height);
+    return (unsigned)clamp(j, 0., (double)(idx->n_rings - 1));
+}
+
+static unsigned
+cell_of(const struct GrvxSpatialIndex *idx, unsigned ring, double lon)
+{
+    const unsigned n = idx->ring_start[ring + 1] - idx->ring_start[ring];
+    const double k = floor((lon + M_PI) / (2. * M_PI) * n);
+    return idx->ring_start[ring] + (unsigned)clamp(k, 0., (double)(n - 1));
+}
+
+void grvx_spatial_index_init(struct GrvxSpatialIndex *idx,
+                             unsigned capacity,
+                             double cell_size)
+{
+    const double n_rings = ceil(M_PI / cell_size);
+    idx->n_rings = (unsigned)clamp(n_rings, 1., GRVX_SPATIAL_MAX_RINGS);
+    idx->ring_height = M_PI / idx->n_rings;
+
+    // the number of cells of each ring is proportional to its circumference
+    idx->ring_start = malloc(sizeof(unsigned) * (idx->n_rings + 1));
+    idx->ring_start[0] = 0;
+    for (unsigned j = 0; j < idx->n_rings; j++) {
+        const double lat = -M_PI / 2. + (j + .5) * idx->ring_height;
+        const double n = round(2. * M_PI * cos(lat) / idx->ring_height);
+        idx->ring_start[j + 1] =
+            idx->ring_start[j] + (n > 1. ? (unsigned)n : 1);
+    }
+
+    const unsigned n_cells = idx->ring_start[idx->n_rings];
+    idx->head = malloc(sizeof(unsigned) * n_cells);
+    for (unsigned c = 0; c < n_cells; c++) {
+        idx->head[c] = GRVX_SPATIAL_NONE;
+    }
+
+    const size_t size = capacity > 0 ? capacity : 1;
+    idx->next = malloc(sizeof(unsigned) * size);
+    idx->x = malloc(sizeof(double) * size);
+    idx->y = malloc(sizeof(double) * size);
+    idx->z = malloc(sizeof(double) * size);
+    idx->n = 0;
+    idx->capacity = capacity;
+}
+
+void grvx_spatial_index_free(struct GrvxSpatialIndex *idx)
+{
+    free(idx->ring_start);
+    free(idx->head);
+    free(idx->next);
+    free(idx->x);
+    free(idx->y);
+    free(idx->z);
+}
+
+unsigned grvx_spatial_index_insert(struct GrvxSpatialIndex *idx,
+                                   const double x[3])
+{
+    const unsigned id = idx->n;
+    idx->n += 1;
+
+    idx->x[id] = x[0];
+    idx->y[id] = x[1];
+    idx->z[id] = x[2];
+
+    const double lat = asin(clamp(x[2], -1., 1.));
+    const double lon = atan2(x[0], x[1]);
+    const unsigned c = cell_of(idx, ring_of(idx, lat), lon);
+    idx->next[id] = idx->head[c];
+    idx->head[c] = id;
+
+    return id;
+}
+
+double grvx_spatial_index_max_dot(const struct GrvxSpatialIndex *idx,
+                                  const double q[3],
+                                  double r,
+                                  unsigned *id)
+{
+    r += MARGIN;
+    const double lat = asin(clamp(q[2], -1., 1.));
+    const double lon = atan2(q[0], q[1]);
+
+    // longitudinal half-width of the cap, which covers all longitudes if the
+    // cap contains a pole
+    const bool pole = lat + r >= M_PI / 2. || lat - r <= -M_PI / 2.;
+    const double sin_r = sin(r);
+    const double cos_lat = cos(lat);
+    const double dlon =
+        pole || sin_r >= cos_lat ? M_PI : asin(sin_r / cos_lat) + MARGIN;
+
+    double best = -2.;
+    unsigned best_id = GRVX_SPATIAL_NONE;
+
+    const unsigned j_lo = ring_of(idx, lat - r);
+    const unsigned j_hi = ring_of(idx, lat + r);
+    for (unsigned j = j_lo; j <= j_hi; j++) {
+        const long n = (long)(idx->ring_start[j + 1] - idx->ring_start[j]);
+
+        long k_lo = 0;
+        long k_hi = n - 1;
+        if (dlon < M_PI) {
+            k_lo = (long)floor((lon - dlon + M_PI) / (2. * M_PI) * (double)n);
+            k_hi = (long)floor((lon + dlon + M_PI) / (2. * M_PI) * (double)n);
+            if (k_hi - k_lo + 1 >= n) {
+                k_lo = 0;
+                k_hi = n - 1;
+            }
+        }
+
+        for (long k = k_lo; k <= k_hi; k++) {
+            // cells wrap around at lon = +/- pi
+            const long kk = (k % n + n) % n;
+            const unsigned c = idx->ring_start[j] + (unsigned)kk;
+            for (unsigned i = idx->head[c]; i != GRVX_SPATIAL_NONE;
+                 i = idx->next[i]) {
+                const double d = q[0] * idx->x[i] + q[1] * idx->y[i] +
+                                 q[2] * idx->z[i];
+                if (d > best) {
+                    best = d;
+                    best_id = i;
+                }
+            }
+        }
+    }
+
+    if (id && best_id != GRVX_SPATIAL_NONE) {
+        *id = best_id;
+    }
+    return best;
+}
+
+unsigned grvx_spatial_index_nearest(const struct GrvxSpatialIndex *idx,
+                                    const double q[3],
+                                    double r,
+                                    double *dot)
+{
+    r = r > idx->ring_height ? r : idx->ring_height;
+
+    // a cap of radius pi covers the whole sphere
+    unsigned id = GRVX_SPATIAL_NONE;
+    double best = grvx_spatial_index_max_dot(idx, q, r, &id);
+    while (best < cos(r) && r < M_PI) {
+        r = 2. * r < M_PI ? 2. * r : M_PI;
+        best = grvx_spatial_index_max_dot(idx, q, r, &id);
+    }
+
+    if (dot) {
+        *dot = best;
+    }
+    return id;
+}
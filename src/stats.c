@@ -0,0 +1,118 @@
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L // clock_gettime()
+#endif
+
+#include "libgravix2/stats.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libgravix2/api.h"
+
+#if GRVX_STATS
+
+_Thread_local struct GrvxStatsBlock *grvx_stats_local = NULL;
+
+static pthread_mutex_t blocks_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct GrvxStatsBlock *blocks = NULL;
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t key;
+
+static void release_block(void *ptr)
+{
+    struct GrvxStatsBlock *block = ptr;
+
+    pthread_mutex_lock(&blocks_mutex);
+    block->in_use = false;
+    pthread_mutex_unlock(&blocks_mutex);
+}
+
+static void create_key(void)
+{
+    pthread_key_create(&key, release_block);
+}
+
+struct GrvxStatsBlock *grvx_stats_acquire(void)
+{
+    pthread_once(&key_once, create_key);
+
+    pthread_mutex_lock(&blocks_mutex);
+    struct GrvxStatsBlock *block = blocks;
+    while (block != NULL && block->in_use) {
+        block = block->next;
+    }
+
+    if (block == NULL) {
+        block = aligned_alloc(GRVX_STATS_ALIGNMENT,
+                              sizeof(struct GrvxStatsBlock));
+        for (unsigned i = 0; i < GRVX_STAT_COUNT; i++) {
+            atomic_init(&block->counters[i], 0);
+        }
+        block->next = blocks;
+        blocks = block;
+    }
+    block->in_use = true;
+    pthread_mutex_unlock(&blocks_mutex);
+
+    // the block is released when the thread terminates
+    pthread_setspecific(key, block);
+    grvx_stats_local = block;
+    return block;
+}
+
+uint64_t grvx_stats_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+int grvx_get_stats(struct GrvxStats *stats)
+{
+    uint64_t sum[GRVX_STAT_COUNT] = {0};
+
+    pthread_mutex_lock(&blocks_mutex);
+    for (struct GrvxStatsBlock *b = blocks; b != NULL; b = b->next) {
+        for (unsigned i = 0; i < GRVX_STAT_COUNT; i++) {
+            sum[i] += atomic_load_explicit(&b->counters[i],
+                                           memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&blocks_mutex);
+
+    stats->n_steps = sum[GRVX_STAT_STEPS];
+    stats->n_force_evaluations = sum[GRVX_STAT_FORCE_EVALUATIONS];
+    stats->n_interactions = sum[GRVX_STAT_INTERACTIONS];
+    stats->n_premature = sum[GRVX_STAT_PREMATURE];
+    stats->n_observations_added = sum[GRVX_STAT_OBSERVATIONS_ADDED];
+    stats->n_observations_popped = sum[GRVX_STAT_OBSERVATIONS_POPPED];
+    stats->t_propagate = 1e-9 * (double)sum[GRVX_STAT_NS_PROPAGATE];
+    stats->t_request_launch = 1e-9 * (double)sum[GRVX_STAT_NS_REQUEST_LAUNCH];
+
+    return 0;
+}
+
+void grvx_reset_stats(void)
+{
+    pthread_mutex_lock(&blocks_mutex);
+    for (struct GrvxStatsBlock *b = blocks; b != NULL; b = b->next) {
+        for (unsigned i = 0; i < GRVX_STAT_COUNT; i++) {
+            atomic_store_explicit(&b->counters[i], 0, memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&blocks_mutex);
+}
+
+#else
+
+int grvx_get_stats(struct GrvxStats *stats)
+{
+    memset(stats, 0, sizeof(struct GrvxStats));
+    return 1;
+}
+
+void grvx_reset_stats(void) {}
+
+#endif
@@ -0,0 +1,258 @@
+#include "libgravix2/tree.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "libgravix2/config.h"
+#include "libgravix2/constants.h"
+
+static double coordinate(const struct GrvxTree *tree, ptrdiff_t i, int axis)
+{
+    return axis == 0 ? tree->x[i] : axis == 1 ? tree->y[i] : tree->z[i];
+}
+
+static void swap(double *a, ptrdiff_t i, ptrdiff_t j)
+{
+    const double tmp = a[i];
+    a[i] = a[j];
+    a[j] = tmp;
+}
+
+static void swap_planets(struct GrvxTree *tree, ptrdiff_t i, ptrdiff_t j)
+{
+    swap(tree->x, i, j);
+    swap(tree->y, i, j);
+    swap(tree->z, i, j);
+}
+
+/*
+ * Partially sorts the planets in [lo, hi) along the given axis s.t. the k-th
+ * planet is in its sorted position (Hoare's selection algorithm).
+ */
+static void select_nth(struct GrvxTree *tree,
+                       ptrdiff_t lo,
+                       ptrdiff_t hi,
+                       ptrdiff_t k,
+                       int axis)
+{
+    while (hi - lo > 1) {
+        const double pivot = coordinate(tree, lo + (hi - lo) / 2, axis);
+
+        ptrdiff_t i = lo;
+        ptrdiff_t j = hi - 1;
+        while (i <= j) {
+            while (coordinate(tree, i, axis) < pivot) {
+                i++;
+            }
+            while (coordinate(tree, j, axis) > pivot) {
+                j--;
+            }
+            if (i <= j) {
+                swap_planets(tree, i, j);
+                i++;
+                j--;
+            }
+        }
+
+        // [lo, j] <= pivot <= [i, hi) and all planets in between equal pivot
+        if (k <= j) {
+            hi = j + 1;
+        } else if (k >= i) {
+            lo = i;
+        } else {
+            return;
+        }
+    }
+}
+
+/*
+ * Places GRVX_TREE_PSEUDO = 3 pseudo-planets of equal weight at the vertices of
+ * a triangle in the tangent plane at the center c s.t. their second moments
+ * match those of the planets, i.e., at c + L v_k with L L^T = C and
+ * v_k = sqrt(2) (cos(2 pi k / 3), sin(2 pi k / 3)), and lifts them back onto
+ * the sphere. Since c points along the sum of the positions, the first moments
+ * in the tangent plane vanish. The radial components then agree with those of
+ * the planets up to fourth order in the angular radius of the cluster.
+ */
+static void init_pseudo_planets(const struct GrvxTree *tree,
+                                struct GrvxTreeNode *node)
+{
+    const unsigned n = node->end - node->begin;
+    const double *c = node->c;
+
+    // clusters of few planets are represented by the planets themselves
+    if (n <= GRVX_TREE_PSEUDO) {
+        for (unsigned k = 0; k < GRVX_TREE_PSEUDO; k++) {
+            const unsigned i = node->begin + (k < n ? k : 0);
+            node->x[k][0] = tree->x[i];
+            node->x[k][1] = tree->y[i];
+            node->x[k][2] = tree->z[i];
+            node->w[k] = k < n ? 1. : 0.;
+        }
+        return;
+    }
+
+    // orthonormal basis of the tangent plane at c
+    const int axis = fabs(c[0]) < fabs(c[1])
+                         ? (fabs(c[0]) < fabs(c[2]) ? 0 : 2)
+                         : (fabs(c[1]) < fabs(c[2]) ? 1 : 2);
+    double t1[3] = {0., 0., 0.};
+    t1[axis] = 1.;
+    const double ct = c[axis];
+    for (unsigned k = 0; k < 3; k++) {
+        t1[k] -= ct * c[k];
+    }
+    const double t1_norm = sqrt(t1[0] * t1[0] + t1[1] * t1[1] + t1[2] * t1[2]);
+    for (unsigned k = 0; k < 3; k++) {
+        t1[k] /= t1_norm;
+    }
+    const double t2[3] = {c[1] * t1[2] - c[2] * t1[1],
+                          c[2] * t1[0] - c[0] * t1[2],
+                          c[0] * t1[1] - c[1] * t1[0]};
+
+    double caa = 0.;
+    double cab = 0.;
+    double cbb = 0.;
+    for (unsigned i = node->begin; i < node->end; i++) {
+        const double a = t1[0] * tree->x[i] + t1[1] * tree->y[i] +
+                         t1[2] * tree->z[i];
+        const double b = t2[0] * tree->x[i] + t2[1] * tree->y[i] +
+                         t2[2] * tree->z[i];
+        caa += a * a;
+        cab += a * b;
+        cbb += b * b;
+    }
+
+    // eigendecomposition of the (normalized) second moments
+    const double mean = .5 * (caa + cbb) / n;
+    const double diff = .5 * (caa - cbb) / n;
+    const double root = sqrt(diff * diff + cab * cab / ((double)n * n));
+    const double l1 = sqrt(2. * (mean + root));
+    const double l2 = sqrt(2. * (mean - root > 0. ? mean - root : 0.));
+    const double phi = .5 * atan2(2. * cab, caa - cbb);
+    const double u[2] = {cos(phi), sin(phi)};
+
+    for (unsigned k = 0; k < GRVX_TREE_PSEUDO; k++) {
+        const double alpha = 2. * M_PI * k / GRVX_TREE_PSEUDO;
+        const double va = l1 * cos(alpha);
+        const double vb = l2 * sin(alpha);
+        const double a = u[0] * va - u[1] * vb;
+        const double b = u[1] * va + u[0] * vb;
+
+        const double r2 = a * a + b * b;
+        const double h = r2 < 1. ? sqrt(1. - r2) : 0.;
+        for (unsigned j = 0; j < 3; j++) {
+            node->x[k][j] = h * c[j] + a * t1[j] + b * t2[j];
+        }
+        node->w[k] = (double)n / GRVX_TREE_PSEUDO;
+    }
+}
+
+static void init_node(struct GrvxTree *tree,
+                      struct GrvxTreeNode *node,
+                      unsigned begin,
+                      unsigned end,
+                      double theta)
+{
+    double s[3] = {0., 0., 0.};
+    for (unsigned i = begin; i < end; i++) {
+        s[0] += tree->x[i];
+        s[1] += tree->y[i];
+        s[2] += tree->z[i];
+    }
+
+    const double norm = sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+    for (unsigned k = 0; k < 3; k++) {
+        // clusters that are spread evenly around the origin are never merged
+        node->c[k] = norm > 0. ? s[k] / norm : (double)(k == 0);
+    }
+
+    double min_dot = 1.;
+    for (unsigned i = begin; i < end; i++) {
+        const double d = node->c[0] * tree->x[i] + node->c[1] * tree->y[i] +
+                         node->c[2] * tree->z[i];
+        min_dot = d < min_dot ? d : min_dot;
+    }
+
+    const double rho = acos(min_dot > -1. ? min_dot : -1.);
+    const double r1 = rho / theta;
+    const double r2 = rho + GRVX_MIN_DIST;
+    const double r_open = r1 > r2 ? r1 : r2;
+
+    // -2 is smaller than any dot product, i.e., the node is always opened
+    node->rho = rho;
+    node->cos_open = r_open < M_PI ? cos(r_open) : -2.;
+    node->begin = begin;
+    node->end = end;
+
+    if (node->cos_open > -2.) {
+        init_pseudo_planets(tree, node);
+    }
+}
+
+static void
+build(struct GrvxTree *tree, unsigned begin, unsigned end, double theta)
+{
+    struct GrvxTreeNode *node = &tree->nodes[tree->n_nodes];
+    tree->n_nodes += 1;
+    init_node(tree, node, begin, end, theta);
+
+    if (end - begin > GRVX_TREE_LEAF_SIZE) {
+        double lo[3] = {2., 2., 2.};
+        double hi[3] = {-2., -2., -2.};
+        for (unsigned i = begin; i < end; i++) {
+            for (int k = 0; k < 3; k++) {
+                const double c = coordinate(tree, i, k);
+                lo[k] = c < lo[k] ? c : lo[k];
+                hi[k] = c > hi[k] ? c : hi[k];
+            }
+        }
+
+        int axis = 0;
+        for (int k = 1; k < 3; k++) {
+            axis = hi[k] - lo[k] > hi[axis] - lo[axis] ? k : axis;
+        }
+
+        const unsigned mid = begin + (end - begin) / 2;
+        select_nth(tree, begin, end, mid, axis);
+        build(tree, begin, mid, theta);
+        build(tree, mid, end, theta);
+    }
+
+    node->skip = tree->n_nodes;
+}
+
+void grvx_tree_build(struct GrvxTree *tree,
+                     const double *x,
+                     const double *y,
+                     const double *z,
+                     unsigned n,
+                     double theta)
+{
+    // a binary tree with at most n leaves has less than 2n nodes
+    const size_t size = n > 0 ? n : 1;
+    tree->nodes = malloc(sizeof(struct GrvxTreeNode) * 2 * size);
+    tree->n_nodes = 0;
+    tree->x = malloc(sizeof(double) * size);
+    tree->y = malloc(sizeof(double) * size);
+    tree->z = malloc(sizeof(double) * size);
+
+    for (unsigned i = 0; i < n; i++) {
+        tree->x[i] = x[i];
+        tree->y[i] = y[i];
+        tree->z[i] = z[i];
+    }
+
+    if (n > 0) {
+        build(tree, 0, n, theta);
+    }
+}
+
+void grvx_tree_free(struct GrvxTree *tree)
+{
+    free(tree->nodes);
+    free(tree->x);
+    free(tree->y);
+    free(tree->z);
+}
@@ -1,7 +1,9 @@
 #include "libgravix2/api.h"
 #include "libgravix2/config.h"
 #include <catch2/catch.hpp>
+#include <cstdint>
 #include <string>
+#include <thread>
 
 TEST_CASE("Test version", "[config]")
 {
@@ -58,4 +60,56 @@ TEST_CASE("Test config", "[config]")
     }
 
     grvx_free_config(cfg);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Test runtime statistics", "[config]")
+{
+    GrvxStats stats;
+    grvx_reset_stats();
+
+#if GRVX_STATS
+    REQUIRE(grvx_get_stats(&stats) == 0);
+#else
+    REQUIRE(grvx_get_stats(&stats) != 0);
+#endif
+    REQUIRE(stats.n_steps == 0);
+    REQUIRE(stats.t_propagate == 0.);
+
+    auto *planets = grvx_new_planets(1);
+    grvx_set_planet(planets, 0, 0., 0.);
+    auto *batch = grvx_new_missiles(1);
+    auto *trj = grvx_get_trajectory(batch, 0);
+
+    // circular orbit w/o collisions, propagated by two threads in turn
+    const double r = .2;
+    grvx_init_missile(trj, r, 0., grvx_v_scrcl(r), 0., 1.);
+    auto propagate = [&] {
+        int premature = 0;
+        REQUIRE(grvx_propagate_missile(trj, planets, 1e-3, &premature) ==
+                GRVX_TRAJECTORY_SIZE);
+        REQUIRE(premature == 0);
+    };
+    propagate();
+    std::thread(propagate).join();
+
+    grvx_get_stats(&stats);
+#if GRVX_STATS
+    const std::uint64_t n_steps = 2 * GRVX_TRAJECTORY_SIZE * GRVX_INT_STEPS;
+    REQUIRE(stats.n_steps == n_steps);
+    REQUIRE(stats.n_force_evaluations == n_steps * GRVX_COMPOSITION_STAGES);
+    REQUIRE(stats.n_interactions == stats.n_force_evaluations);
+    REQUIRE(stats.n_premature == 0);
+    REQUIRE(stats.t_propagate > 0.);
+#else
+    REQUIRE(stats.n_steps == 0);
+    REQUIRE(stats.n_force_evaluations == 0);
+    REQUIRE(stats.t_propagate == 0.);
+#endif
+
+    grvx_reset_stats();
+    grvx_get_stats(&stats);
+    REQUIRE(stats.n_steps == 0);
+
+    grvx_delete_missiles(batch);
+    grvx_delete_planets(planets);
+}
@@ -6,6 +6,7 @@
 #include <future>
 #include <limits>
 #include <numbers>
+#include <numeric>
 #include <random>
 #include <set>
 
@@ -139,6 +140,113 @@ TEST_CASE("Test planet distribution", "[game]")
     }
 }
 
+TEST_CASE("Test planet initialization of large universes", "[game]")
+{
+    const unsigned N = 20000;
+    const double min_dist = 1. / std::sqrt(N);
+
+    auto *planets = grvx_new_planets(N);
+    unsigned seed = 42;
+    const auto n_draws = grvx_rnd_init_planets(planets, &seed, min_dist);
+    REQUIRE(n_draws >= static_cast<std::int32_t>(N));
+
+    std::vector<double> lat(N), lon(N);
+    REQUIRE(grvx_get_planets(planets, N, lat.data(), lon.data()) == 0);
+
+    // compares all pairs via sorted latitudes, which differ by less than the
+    // distance of their planets
+    std::vector<unsigned> order(N);
+    std::iota(order.begin(), order.end(), 0U);
+    std::sort(order.begin(), order.end(), [&](auto i, auto j) {
+        return lat[i] < lat[j];
+    });
+    for (unsigned a = 0; a < N; a++) {
+        const auto i = order[a];
+        for (unsigned b = a + 1; b < N && lat[order[b]] - lat[i] < min_dist;
+             b++) {
+            const auto j = order[b];
+            REQUIRE(grvx::testing::great_circle_distance(
+                        lat[i], lon[i], lat[j], lon[j]) >= min_dist * .999999);
+        }
+    }
+
+    // same seed, same universe
+    auto *planets2 = grvx_new_planets(N);
+    unsigned seed2 = 42;
+    REQUIRE(grvx_rnd_init_planets(planets2, &seed2, min_dist) == n_draws);
+    REQUIRE(seed2 == seed);
+    std::vector<double> lat2(N), lon2(N);
+    REQUIRE(grvx_get_planets(planets2, N, lat2.data(), lon2.data()) == 0);
+    REQUIRE(lat2 == lat);
+    REQUIRE(lon2 == lon);
+
+    grvx_delete_planets(planets2);
+    grvx_delete_planets(planets);
+}
+
+TEST_CASE("Test counter-based random numbers", "[game]")
+{
+    auto root = grvx_init_rng(42);
+
+    // skipping ahead equals drawing
+    auto rng = root;
+    std::vector<std::uint64_t> words;
+    for (unsigned i = 0; i < 100; i++) {
+        words.push_back(grvx_rng_next(&rng));
+    }
+    REQUIRE(rng.counter == 100);
+    auto skipped = root;
+    skipped.counter += 57;
+    REQUIRE(grvx_rng_next(&skipped) == words[57]);
+
+    // streams depend on the key only and differ from each other
+    REQUIRE(grvx_split_rng(&rng, 3).key == grvx_split_rng(&root, 3).key);
+    std::set<std::uint64_t> firsts;
+    for (std::uint64_t stream = 0; stream < 1000; stream++) {
+        auto child = grvx_split_rng(&root, stream);
+        firsts.insert(grvx_rng_next(&child));
+    }
+    REQUIRE(firsts.size() == 1000);
+
+    const unsigned N = 100000;
+    double mean = 0.;
+    for (unsigned i = 0; i < N; i++) {
+        const double u = grvx_rng_uniform(&rng);
+        REQUIRE(u >= 0.);
+        REQUIRE(u < 1.);
+        mean += u / N;
+    }
+    REQUIRE(mean == Approx(.5).margin(.005));
+
+    // universes only depend on their stream
+    const unsigned N_PLANETS = 50;
+    auto *planets = grvx_new_planets(N_PLANETS);
+    auto *planets2 = grvx_new_planets(N_PLANETS);
+    auto rng1 = grvx_split_rng(&root, 7);
+    auto rng2 = grvx_split_rng(&root, 7);
+    const auto n = grvx_rng_init_planets(planets, &rng1, .1);
+    REQUIRE(n >= static_cast<std::int32_t>(N_PLANETS));
+    REQUIRE(rng1.counter == 2U * n);
+    grvx_rng_next(&rng2);
+    rng2.counter = 0;
+    REQUIRE(grvx_rng_init_planets(planets2, &rng2, .1) == n);
+    for (unsigned i = 0; i < N_PLANETS; i++) {
+        double lat1, lon1, lat2, lon2;
+        grvx_get_planet(planets, i, &lat1, &lon1);
+        grvx_get_planet(planets2, i, &lat2, &lon2);
+        REQUIRE(lat1 == lat2);
+        REQUIRE(lon1 == lon2);
+        for (unsigned j = 0; j < i; j++) {
+            grvx_get_planet(planets, j, &lat2, &lon2);
+            REQUIRE(grvx::testing::great_circle_distance(
+                        lat1, lon1, lat2, lon2) > .1);
+        }
+    }
+
+    grvx_delete_planets(planets2);
+    grvx_delete_planets(planets);
+}
+
 TEST_CASE("Test tick")
 {
     const double H = .1;
@@ -200,3 +308,306 @@ TEST_CASE("Test tick")
     grvx_delete_game(game);
     grvx_delete_planets(planets);
 }
+
+TEST_CASE("Test missiles in flight", "[game]")
+{
+    const double H = .1;
+    const unsigned N_MISSILES = 32;
+
+    auto planets = grvx_new_planets(4);
+    unsigned seed = 42;
+    grvx_rnd_init_planets(planets, &seed, .5);
+
+    // pings are observed at the same relative position after the launch,
+    // regardless of the tick of the request and of other missiles in flight
+    auto observe_pings = [&](unsigned tick, unsigned n_missiles) {
+        auto game = grvx_init_game(planets);
+
+        std::uint32_t t = 0;
+        while (t < tick) {
+            REQUIRE(grvx_observe_or_tick(game, &t) == nullptr);
+        }
+
+        for (unsigned i = 0; i < n_missiles; i++) {
+            GrvxMissileLaunch m{.t_start = tick + .3,
+                                .dt_ping = 1. + .05 * i,
+                                .dt_end = 3.,
+                                .v = 1.,
+                                .psi = .2 * i};
+            REQUIRE(grvx_request_launch(game, i % 4, &m, H) == 0);
+        }
+
+        std::vector<GrvxMissileObservation> pings;
+        while (t < tick + 4) {
+            auto *obs = grvx_observe_or_tick(game, &t);
+            if (obs != nullptr && obs->planet_id == 4) {
+                pings.push_back(*obs);
+            }
+        }
+
+        grvx_delete_game(game);
+        return pings;
+    };
+
+    const auto pings0 = observe_pings(0, 1);
+    REQUIRE(pings0.size() == 1);
+    REQUIRE(pings0[0].t == Approx(1.3));
+
+    const auto pings = observe_pings(5, N_MISSILES);
+    REQUIRE(pings.size() > 1);
+    REQUIRE(pings[0].t == Approx(6.3));
+    REQUIRE(pings[0].lat == Approx(pings0[0].lat));
+    REQUIRE(pings[0].lon == Approx(pings0[0].lon));
+    for (unsigned i = 1; i < pings.size(); i++) {
+        REQUIRE(pings[i].t > pings[i - 1].t);
+    }
+
+    grvx_delete_planets(planets);
+}
+
+TEST_CASE("Test observation order", "[game]")
+{
+    const double H = .1;
+    const unsigned N_MISSILES = 200;
+
+    auto planets = grvx_new_planets(4);
+    unsigned seed = 42;
+    grvx_rnd_init_planets(planets, &seed, .5);
+    auto game = grvx_init_game(planets);
+
+    std::mt19937 rnd{42};
+    std::uniform_real_distribution<double> u{0., 1.};
+    for (unsigned i = 0; i < N_MISSILES; i++) {
+        const double dt_ping = .1 + .8 * u(rnd);
+        GrvxMissileLaunch m{.t_start = .05,
+                            .dt_ping = dt_ping,
+                            .dt_end = dt_ping + .01,
+                            .v = 1.,
+                            .psi = 2. * std::numbers::pi * u(rnd)};
+        REQUIRE(grvx_request_launch(game, i % 4, &m, H) == 0);
+    }
+
+    std::uint32_t t = 0;
+    std::vector<double> pings;
+    while (t < 2) {
+        auto *obs = grvx_observe_or_tick(game, &t);
+        if (obs != nullptr) {
+            REQUIRE(obs->planet_id == 4);
+            pings.push_back(obs->t);
+        }
+    }
+
+    REQUIRE(pings.size() == N_MISSILES);
+    REQUIRE(std::is_sorted(pings.begin(), pings.end()));
+
+    grvx_delete_game(game);
+    grvx_delete_planets(planets);
+}
+
+TEST_CASE("Test game snapshot", "[game]")
+{
+    const double H = .1;
+
+    auto planets = grvx_new_planets(8);
+    unsigned seed = 42;
+    grvx_rnd_init_planets(planets, &seed, .3);
+    REQUIRE(grvx_set_opening_angle(planets, .2) == 0);
+    auto game = grvx_init_game(planets);
+
+    for (unsigned i = 0; i < 16; i++) {
+        GrvxMissileLaunch m{.t_start = .5 + .25 * i,
+                            .dt_ping = 1. + .1 * i,
+                            .dt_end = 10.,
+                            .v = 1.,
+                            .psi = .4 * i};
+        REQUIRE(grvx_request_launch(game, i % 8, &m, H) == 0);
+    }
+
+    std::uint32_t t = 0;
+    while (t < 3) {
+        grvx_observe_or_tick(game, &t);
+    }
+
+    const auto size = grvx_save_game(game, nullptr, 0);
+    std::vector<unsigned char> buffer(size);
+    REQUIRE(grvx_save_game(game, buffer.data(), size) == size);
+
+    // every cut-off snapshot is rejected
+    for (size_t n = 0; n < size; n++) {
+        GrvxPlanetsHandle truncated_planets = nullptr;
+        REQUIRE(grvx_load_game(buffer.data(), n, &truncated_planets) ==
+                nullptr);
+        REQUIRE(truncated_planets == nullptr);
+    }
+    auto corrupted = buffer;
+    corrupted[0] ^= 1;
+    REQUIRE(grvx_load_game(corrupted.data(), size, &planets) == nullptr);
+
+    GrvxPlanetsHandle restored_planets = nullptr;
+    auto restored = grvx_load_game(buffer.data(), size, &restored_planets);
+    REQUIRE(restored != nullptr);
+    REQUIRE(grvx_count_planets(restored_planets) == 8);
+    REQUIRE(grvx_get_opening_angle(restored_planets) == .2);
+
+    // both games continue bit-identically
+    std::uint32_t t2 = t;
+    unsigned n_obs = 0;
+    while (t < 12) {
+        auto *obs = grvx_observe_or_tick(game, &t);
+        auto *obs2 = grvx_observe_or_tick(restored, &t2);
+        REQUIRE(t == t2);
+        REQUIRE((obs == nullptr) == (obs2 == nullptr));
+        if (obs != nullptr) {
+            REQUIRE(obs->planet_id == obs2->planet_id);
+            REQUIRE(obs->t == obs2->t);
+            REQUIRE(obs->lat == obs2->lat);
+            REQUIRE(obs->lon == obs2->lon);
+            n_obs += 1;
+        }
+    }
+    REQUIRE(n_obs > 0);
+
+    grvx_delete_game(restored);
+    grvx_delete_planets(restored_planets);
+    grvx_delete_game(game);
+    grvx_delete_planets(planets);
+}
+
+TEST_CASE("Test game host", "[game]")
+{
+    const double H = .1;
+    const unsigned N_GAMES = 6;
+
+    auto planets = grvx_new_planets(8);
+    unsigned seed = 42;
+    grvx_rnd_init_planets(planets, &seed, .3);
+
+    auto pool = grvx_new_pool(3, nullptr);
+    REQUIRE(pool != nullptr);
+    auto host = grvx_new_game_host(pool);
+
+    // each hosted game has a twin that is driven serially
+    std::vector<GrvxGameHandle> twins;
+    std::vector<std::uint32_t> indices;
+    for (unsigned g = 0; g < N_GAMES; g++) {
+        twins.push_back(grvx_init_game(planets));
+        indices.push_back(grvx_host_game(host, grvx_init_game(planets)));
+    }
+
+    REQUIRE(grvx_host_output(host, N_GAMES) == nullptr);
+    REQUIRE(grvx_host_request_launch(host, N_GAMES, 0, nullptr, H) != 0);
+
+    std::uint32_t t = 0;
+    unsigned n_obs = 0;
+    for (unsigned round = 0; round < 8; round++) {
+        std::vector<std::vector<std::int32_t>> rcs(N_GAMES);
+        for (unsigned g = 0; g < N_GAMES; g++) {
+            for (unsigned i = 0; i < g + round % 3; i++) {
+                // every other round, launches are partly in the past
+                GrvxMissileLaunch m{.t_start = t + .1 * i - (round % 2),
+                                    .dt_ping = .5 + .1 * g,
+                                    .dt_end = 5.,
+                                    .v = 1.,
+                                    .psi = .3 * i + g};
+                const auto planet_id = (i + g) % 8;
+                REQUIRE(grvx_host_request_launch(
+                            host, indices[g], planet_id, &m, H) == 0);
+                rcs[g].push_back(
+                    grvx_request_launch(twins[g], planet_id, &m, H));
+            }
+        }
+
+        grvx_run_host_round(host);
+        t += 1;
+
+        for (unsigned g = 0; g < N_GAMES; g++) {
+            auto *out = grvx_host_output(host, indices[g]);
+            REQUIRE(out != nullptr);
+            REQUIRE(out->tick == t);
+            REQUIRE(out->n_launches == rcs[g].size());
+            for (unsigned i = 0; i < out->n_launches; i++) {
+                REQUIRE(out->launch_rc[i] == rcs[g][i]);
+            }
+
+            std::uint32_t t2 = 0;
+            unsigned k = 0;
+            while (auto *obs = grvx_observe_or_tick(twins[g], &t2)) {
+                REQUIRE(k < out->n_observations);
+                REQUIRE(out->observations[k].planet_id == obs->planet_id);
+                REQUIRE(out->observations[k].t == obs->t);
+                REQUIRE(out->observations[k].lat == obs->lat);
+                REQUIRE(out->observations[k].lon == obs->lon);
+                k += 1;
+            }
+            REQUIRE(t2 == t);
+            REQUIRE(k == out->n_observations);
+            n_obs += k;
+        }
+    }
+    REQUIRE(n_obs > 0);
+
+    // slots of returned games are reused
+    auto game = grvx_unhost_game(host, indices[2]);
+    REQUIRE(game != nullptr);
+    REQUIRE(grvx_hosted_game(host, indices[2]) == nullptr);
+    REQUIRE(grvx_host_game(host, game) == indices[2]);
+    REQUIRE(grvx_hosted_game(host, indices[2]) == game);
+
+    grvx_delete_game_host(host);
+    for (auto twin : twins) {
+        grvx_delete_game(twin);
+    }
+    grvx_delete_pool(pool);
+    grvx_delete_planets(planets);
+}
+
+TEST_CASE("Test game with fixed capacity", "[game]")
+{
+    const double H = .1;
+    const unsigned MAX_FLIGHTS = 2;
+
+    auto planets = grvx_new_planets(8);
+    unsigned seed = 42;
+    grvx_rnd_init_planets(planets, &seed, .3);
+    auto game = grvx_init_game(planets);
+    auto fixed = grvx_init_game_fixed(planets, MAX_FLIGHTS);
+    REQUIRE(fixed != nullptr);
+
+    std::uint32_t t = 0;
+    std::uint32_t t2 = 0;
+    unsigned n_obs = 0;
+    unsigned n_rejected = 0;
+    for (unsigned i = 0; t < 20; i++) {
+        GrvxMissileLaunch m{.t_start = t + .5,
+                            .dt_ping = .5 + .1 * (i % 5),
+                            .dt_end = 1. + (i % 3),
+                            .v = 1.,
+                            .psi = .3 * i};
+        const auto rc = grvx_request_launch(fixed, i % 8, &m, H);
+        if (rc == 0) {
+            REQUIRE(grvx_request_launch(game, i % 8, &m, H) == 0);
+        } else {
+            n_rejected += 1;
+        }
+
+        // the fixed game is identical to a game w/o limits and same launches
+        GrvxMissileObservation *obs;
+        do {
+            obs = grvx_observe_or_tick(game, &t);
+            auto *obs2 = grvx_observe_or_tick(fixed, &t2);
+            REQUIRE(t == t2);
+            REQUIRE((obs == nullptr) == (obs2 == nullptr));
+            if (obs != nullptr) {
+                REQUIRE(obs->planet_id == obs2->planet_id);
+                REQUIRE(obs->t == obs2->t);
+                n_obs += 1;
+            }
+        } while (obs != nullptr);
+    }
+    REQUIRE(n_obs > 0);
+    REQUIRE(n_rejected > 0);
+
+    grvx_delete_game(fixed);
+    grvx_delete_game(game);
+    grvx_delete_planets(planets);
+}
@@ -1,6 +1,7 @@
 #include "libgravix2/api.h"
 #include <catch2/catch.hpp>
 #include <cmath>
+#include <numbers>
 
 TEST_CASE("Test lat/lon conversions", "[helpers]")
 {
@@ -16,4 +17,41 @@ TEST_CASE("Test lat/lon conversions", "[helpers]")
     double vz = +.1 * ca;
     REQUIRE(grvx_vlat(vx, vy, vz, .2, .3) == Approx(vz / ca));
     REQUIRE(grvx_vlon(vx, vy, vz, .3) == Approx(vx * cb - vy * sb));
-}
\ No newline at end of file
+}
+
+TEST_CASE("Test packed samples", "[helpers]")
+{
+    const double MAX_ERR = 5e-5;
+
+    auto [lat, lon] = GENERATE(std::make_pair(0., 0.),
+                               std::make_pair(.3, -2.),
+                               std::make_pair(-1.2, 3.),
+                               std::make_pair(std::numbers::pi / 2., 0.),
+                               std::make_pair(-std::numbers::pi / 2., 1.),
+                               std::make_pair(-.01, std::numbers::pi));
+
+    GrvxMissileState state;
+    REQUIRE(grvx_init_missile_state(&state, lat, lon, 2., .6, -.8) == 0);
+
+    GrvxPackedSample sample;
+    grvx_pack_sample(&state, &sample);
+
+    GrvxMissileState decoded;
+    grvx_unpack_sample(&sample, &decoded);
+
+    double cos_err = 0.;
+    double radial = 0.;
+    for (unsigned c = 0; c < 3; c++) {
+        cos_err += state.x[c] * decoded.x[c];
+        radial += decoded.x[c] * decoded.v[c];
+        REQUIRE(decoded.v[c] == Approx(state.v[c]).margin(2. * MAX_ERR));
+    }
+    REQUIRE(std::acos(std::min(cos_err, 1.)) < MAX_ERR);
+    REQUIRE(radial == Approx(0.).margin(1e-12));
+
+    REQUIRE(grvx_packed_lat(&sample) == Approx(lat).margin(MAX_ERR));
+    if (std::abs(lat) < 1.) {
+        REQUIRE(std::cos(grvx_packed_lon(&sample) - lon) ==
+                Approx(1.).margin(MAX_ERR));
+    }
+}
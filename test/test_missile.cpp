@@ -1,7 +1,16 @@
 #include "helpers.hpp"
 #include "libgravix2/api.h"
+#include "libgravix2/config.h"
 #include <catch2/catch.hpp>
+#include <algorithm>
+#include <cfloat>
 #include <cmath>
+#include <cstdint>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <utility>
+#include <vector>
 
 TEST_CASE("Test missile", "[missile]")
 {
@@ -110,4 +119,749 @@ TEST_CASE("Test perturbed measurements", "[missile]")
     }
 
     grvx_delete_planets(planets);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Test batch propagation", "[missile]")
+{
+    const double H = 1e-3;
+    const double V = grvx_v_esc();
+
+    auto planets = grvx_new_planets(3);
+    REQUIRE(grvx_set_planet(planets, 0, 0., 0.) == 0);
+    REQUIRE(grvx_set_planet(planets, 1, .5, 1.) == 0);
+    REQUIRE(grvx_set_planet(planets, 2, -.7, 2.5) == 0);
+
+    // not a multiple of the number of SIMD lanes
+    const unsigned N = 11;
+    auto scalar = grvx_new_missiles(N);
+    auto batch = grvx_new_missiles(N);
+    for (unsigned i = 0; i < N; i++) {
+        const double v = (.5 + .2 * i) * V;
+        const double psi = .7 * i;
+        REQUIRE(grvx_launch_missile(grvx_get_trajectory(scalar, i),
+                                    planets,
+                                    i % 3,
+                                    v,
+                                    psi) == 0);
+        REQUIRE(grvx_launch_missile(grvx_get_trajectory(batch, i),
+                                    planets,
+                                    i % 3,
+                                    v,
+                                    psi) == 0);
+    }
+
+    std::vector<std::uint32_t> n_steps(N);
+    std::vector<std::int32_t> premature(N);
+
+    // chained calls continue from the last state as in the scalar case
+    for (int k = 0; k < 3; k++) {
+        grvx_propagate_missiles(
+            batch, N, planets, H, n_steps.data(), premature.data());
+
+        for (unsigned i = 0; i < N; i++) {
+            INFO("Call k=" << k << ", missile i=" << i);
+
+            auto *m1 = grvx_get_trajectory(scalar, i);
+            auto *m2 = grvx_get_trajectory(batch, i);
+
+            int premature1 = 0;
+            auto n = grvx_propagate_missile(m1, planets, H, &premature1);
+            REQUIRE(n_steps[i] == n);
+            REQUIRE(premature[i] == premature1);
+
+            for (unsigned j = 0; j < n; j++) {
+                for (unsigned c = 0; c < 3; c++) {
+                    REQUIRE(m1->x[j][c] == Approx(m2->x[j][c]));
+                    REQUIRE(m1->v[j][c] == Approx(m2->v[j][c]));
+                }
+            }
+        }
+    }
+
+    grvx_delete_missiles(scalar);
+    grvx_delete_missiles(batch);
+    grvx_delete_planets(planets);
+}
+
+TEST_CASE("Test batch propagation in single precision", "[missile]")
+{
+    const double H = 1e-3;
+    const double V = grvx_v_esc();
+
+    auto planets = grvx_new_planets(3);
+    REQUIRE(grvx_set_planet(planets, 0, 0., 0.) == 0);
+    REQUIRE(grvx_set_planet(planets, 1, .5, 1.) == 0);
+    REQUIRE(grvx_set_planet(planets, 2, -.7, 2.5) == 0);
+
+    // same orbits as in the double precision batch
+    const unsigned N = 11;
+    auto f64 = grvx_new_missiles(N);
+    auto f32 = grvx_new_missiles(N);
+    std::vector<std::vector<double>> v0(N);
+    for (unsigned i = 0; i < N; i++) {
+        const double v = (.5 + .2 * i) * V;
+        const double psi = .7 * i;
+        REQUIRE(grvx_launch_missile(
+                    grvx_get_trajectory(f64, i), planets, i % 3, v, psi) == 0);
+        REQUIRE(grvx_launch_missile(
+                    grvx_get_trajectory(f32, i), planets, i % 3, v, psi) == 0);
+
+        const auto *launch = grvx_get_trajectory(f64, i)->v;
+        v0[i].assign(launch[GRVX_TRAJECTORY_SIZE - 1],
+                     launch[GRVX_TRAJECTORY_SIZE - 1] + 3);
+    }
+
+    std::vector<std::uint32_t> n_steps64(N);
+    std::vector<std::int32_t> premature64(N);
+    grvx_propagate_missiles(
+        f64, N, planets, H, n_steps64.data(), premature64.data());
+
+    std::vector<std::uint32_t> n_steps32(N);
+    std::vector<std::int32_t> premature32(N);
+    grvx_propagate_missiles_f32(
+        f32, N, planets, H, n_steps32.data(), premature32.data());
+
+    // The force is dominated by the cancellation in 1 - cos(d) close to
+    // planets, i.e., its relative rounding error is at most delta. The
+    // resulting velocity errors are proportional to the accumulated impulse
+    // and let the trajectories drift apart at most linearly in time. The
+    // estimate is of leading order only, hence the factor 2.
+    const double delta = FLT_EPSILON / (1. - std::cos(GRVX_MIN_DIST));
+    for (unsigned i = 0; i < N; i++) {
+        INFO("Missile i=" << i);
+        REQUIRE(n_steps32[i] == n_steps64[i]);
+        REQUIRE(premature32[i] == premature64[i]);
+
+        auto *m64 = grvx_get_trajectory(f64, i);
+        auto *m32 = grvx_get_trajectory(f32, i);
+        const double *v_prev = v0[i].data();
+        double impulse = 0.;
+        for (unsigned j = 0; j < n_steps64[i]; j++) {
+            double d2 = 0.;
+            double dv2 = 0.;
+            for (unsigned c = 0; c < 3; c++) {
+                d2 += std::pow(m32->x[j][c] - m64->x[j][c], 2);
+                dv2 += std::pow(m64->v[j][c] - v_prev[c], 2);
+            }
+            impulse += std::sqrt(dv2);
+            v_prev = m64->v[j];
+
+            const double t = (j + 1.) * GRVX_INT_STEPS * H;
+            REQUIRE(std::sqrt(d2) <= 2. * delta * impulse * t);
+        }
+    }
+
+    grvx_delete_missiles(f64);
+    grvx_delete_missiles(f32);
+    grvx_delete_planets(planets);
+}
+
+TEST_CASE("Test bulk launch", "[missile]")
+{
+    auto planets = grvx_new_planets(2);
+    REQUIRE(grvx_set_planet(planets, 0, 0., 0.) == 0);
+    REQUIRE(grvx_set_planet(planets, 1, .5, 1.) == 0);
+
+    const unsigned N = 3;
+    const std::uint32_t planet_id[N] = {1, 0, 1};
+    const double v[N] = {.1, .2, .3};
+    const double psi[N] = {-1., 0., 2.};
+
+    auto single = grvx_new_missiles(N);
+    auto bulk = grvx_new_missiles(N);
+
+    const std::uint32_t invalid_id[N] = {0, 2, 1};
+    REQUIRE(grvx_launch_missiles(bulk, N, planets, invalid_id, v, psi) != 0);
+    REQUIRE(grvx_launch_missiles(bulk, N, planets, planet_id, v, psi) == 0);
+
+    for (unsigned i = 0; i < N; i++) {
+        auto *m1 = grvx_get_trajectory(single, i);
+        auto *m2 = grvx_get_trajectory(bulk, i);
+        REQUIRE(grvx_launch_missile(m1, planets, planet_id[i], v[i], psi[i]) ==
+                0);
+        for (unsigned c = 0; c < 3; c++) {
+            REQUIRE(m1->x[0][c] == m2->x[0][c]);
+            REQUIRE(m1->v[0][c] == m2->v[0][c]);
+        }
+    }
+
+    grvx_delete_missiles(single);
+    grvx_delete_missiles(bulk);
+    grvx_delete_planets(planets);
+}
+
+// scatters the planets uniformly over the sphere, reproducibly
+static void random_planets(GrvxPlanetsHandle planets)
+{
+    std::mt19937 gen{42};
+    std::uniform_real_distribution<double> u{-1., 1.};
+    const auto n = grvx_count_planets(planets);
+    for (unsigned i = 0; i < n; i++) {
+        const double lon = u(gen) * std::numbers::pi;
+        grvx_set_planet(planets, i, std::asin(u(gen)), lon);
+    }
+}
+
+// a single sample is enough to compare the forces along the trajectories
+static std::pair<std::vector<double>, std::vector<double>>
+first_sample(GrvxPlanetsHandle planets)
+{
+    auto batch = grvx_new_missiles(1);
+    auto *trj = grvx_get_trajectory(batch, 0);
+    REQUIRE(grvx_launch_missile(trj, planets, 0, 1., .5) == 0);
+
+    std::int32_t premature = 0;
+    REQUIRE(grvx_propagate_missile(trj, planets, 1e-4, &premature) > 1);
+
+    std::vector<double> x(trj->x[1], trj->x[1] + 3);
+    std::vector<double> v(trj->v[1], trj->v[1] + 3);
+    grvx_delete_missiles(batch);
+    return {x, v};
+}
+
+TEST_CASE("Test tree force engine", "[missile]")
+{
+    const unsigned N_PLANETS = 2000;
+    auto planets = grvx_new_planets(N_PLANETS);
+    REQUIRE(grvx_get_opening_angle(planets) == 0.);
+    REQUIRE(grvx_set_opening_angle(planets, -.1) != 0);
+    REQUIRE(grvx_set_opening_angle(planets, 1.1) != 0);
+
+    random_planets(planets);
+    auto propagate = [&](double theta) {
+        REQUIRE(grvx_set_opening_angle(planets, theta) == 0);
+        return first_sample(planets);
+    };
+
+    const auto [x0, v0] = propagate(0.);
+    const auto [x1, v1] = propagate(.1);
+    const auto [x2, v2] = propagate(.5);
+    for (unsigned k = 0; k < 3; k++) {
+        REQUIRE(x1[k] == Approx(x0[k]).margin(1e-7));
+        REQUIRE(v1[k] == Approx(v0[k]).margin(1e-4));
+        REQUIRE(v2[k] == Approx(v0[k]).margin(5e-2));
+    }
+
+    // each approximated contribution has a relative error of order theta^3,
+    // i.e., halving theta reduces the error by at least a factor 2^3
+    REQUIRE(grvx_set_opening_angle(planets, .2) == 0);
+    const double err1 = grvx_field_error(planets, 1000);
+    REQUIRE(grvx_set_opening_angle(planets, .1) == 0);
+    const double err2 = grvx_field_error(planets, 1000);
+    REQUIRE(err2 > 0.);
+    REQUIRE(err1 / err2 > 8.);
+
+    grvx_delete_planets(planets);
+}
+
+TEST_CASE("Test baked force field", "[missile]")
+{
+    const unsigned N_PLANETS = 200;
+    auto planets = grvx_new_planets(N_PLANETS);
+    REQUIRE(grvx_bake_field(planets, 32, 0.) != 0);
+    REQUIRE(grvx_bake_field(planets, 32, 2.) != 0);
+    REQUIRE(grvx_bake_field(planets, 0, 0.) == 0);
+
+    random_planets(planets);
+    REQUIRE(grvx_field_error(planets, 100) == 0.);
+
+    const auto [x0, v0] = first_sample(planets);
+
+    REQUIRE(grvx_bake_field(planets, 32, .2) == 0);
+    const double err32 = grvx_field_error(planets, 1000);
+    REQUIRE(grvx_bake_field(planets, 64, .2) == 0);
+    const double err64 = grvx_field_error(planets, 1000);
+    REQUIRE(err32 > 0.);
+    REQUIRE(err32 < 1e-1);
+
+    // bilinear interpolation
+    REQUIRE(err64 < err32 / 3.);
+
+    const auto [x1, v1] = first_sample(planets);
+    for (unsigned k = 0; k < 3; k++) {
+        REQUIRE(v1[k] == Approx(v0[k]).margin(1e-3));
+    }
+
+    // moving a planet invalidates the field, i.e., it equals a fresh bake of
+    // the moved planets
+    grvx_set_planet(planets, 0, 0., 0.);
+    auto moved = grvx_new_planets(N_PLANETS);
+    random_planets(moved);
+    grvx_set_planet(moved, 0, 0., 0.);
+    REQUIRE(grvx_bake_field(moved, 64, .2) == 0);
+    REQUIRE(grvx_field_error(planets, 1000) == grvx_field_error(moved, 1000));
+    REQUIRE(first_sample(planets) == first_sample(moved));
+
+    grvx_delete_planets(moved);
+    grvx_delete_planets(planets);
+}
+
+TEST_CASE("Test parallel batch propagation", "[missile]")
+{
+    const double H = 1e-3;
+    const double V = grvx_v_esc();
+
+    auto planets = grvx_new_planets(3);
+    REQUIRE(grvx_set_planet(planets, 0, 0., 0.) == 0);
+    REQUIRE(grvx_set_planet(planets, 1, .5, 1.) == 0);
+    REQUIRE(grvx_set_planet(planets, 2, -.7, 2.5) == 0);
+
+    const unsigned n_threads = GENERATE(1u, 3u);
+    auto pool = grvx_new_pool(n_threads, nullptr);
+    REQUIRE(pool != nullptr);
+    REQUIRE(grvx_count_threads(pool) == n_threads);
+
+    // several chunks per thread of very different costs
+    const unsigned N = 61;
+    auto serial = grvx_new_missiles(N);
+    auto parallel = grvx_new_missiles(N);
+    for (unsigned i = 0; i < N; i++) {
+        const double v = (.5 + .05 * i) * V;
+        const double psi = .7 * i;
+        REQUIRE(grvx_launch_missile(grvx_get_trajectory(serial, i),
+                                    planets,
+                                    i % 3,
+                                    v,
+                                    psi) == 0);
+        REQUIRE(grvx_launch_missile(grvx_get_trajectory(parallel, i),
+                                    planets,
+                                    i % 3,
+                                    v,
+                                    psi) == 0);
+    }
+
+    std::vector<std::uint32_t> n_steps1(N), n_steps2(N);
+    std::vector<std::int32_t> premature1(N), premature2(N);
+
+    grvx_propagate_missiles(
+        serial, N, planets, H, n_steps1.data(), premature1.data());
+    grvx_propagate_batch_parallel(pool,
+                                  parallel,
+                                  N,
+                                  planets,
+                                  H,
+                                  n_steps2.data(),
+                                  premature2.data());
+
+    for (unsigned i = 0; i < N; i++) {
+        INFO("Missile i=" << i);
+        REQUIRE(n_steps1[i] == n_steps2[i]);
+        REQUIRE(premature1[i] == premature2[i]);
+
+        auto *m1 = grvx_get_trajectory(serial, i);
+        auto *m2 = grvx_get_trajectory(parallel, i);
+        for (unsigned j = 0; j < n_steps1[i]; j++) {
+            for (unsigned c = 0; c < 3; c++) {
+                REQUIRE(m1->x[j][c] == m2->x[j][c]);
+                REQUIRE(m1->v[j][c] == m2->v[j][c]);
+            }
+        }
+    }
+
+    grvx_delete_pool(pool);
+    grvx_delete_missiles(serial);
+    grvx_delete_missiles(parallel);
+    grvx_delete_planets(planets);
+}
+
+TEST_CASE("Test streaming propagation", "[missile]")
+{
+    const double H = 1e-3;
+
+    auto *cfg = grvx_get_config();
+    const auto int_steps = cfg->int_steps;
+    const auto trj_size = cfg->trajectory_size;
+    grvx_free_config(cfg);
+
+    auto planets = grvx_new_planets(2);
+    REQUIRE(grvx_set_planet(planets, 0, 0., 0.) == 0);
+    REQUIRE(grvx_set_planet(planets, 1, .5, 1.) == 0);
+
+    auto trj = grvx_new_missiles(1);
+    auto *m = grvx_get_trajectory(trj, 0);
+    REQUIRE(grvx_launch_missile(m, planets, 0, .8 * grvx_v_esc(), .3) == 0);
+
+    GrvxMissileState state;
+    REQUIRE(grvx_launch_missile_state(&state, planets, 2, 1., 0.) != 0);
+    REQUIRE(grvx_launch_missile_state(
+                &state, planets, 0, .8 * grvx_v_esc(), .3) == 0);
+    for (unsigned c = 0; c < 3; c++) {
+        REQUIRE(state.x[c] == m->x[0][c]);
+        REQUIRE(state.v[c] == m->v[0][c]);
+    }
+
+    auto collect = [](void *ctx, std::uint32_t, const GrvxMissileState *s) {
+        static_cast<std::vector<GrvxMissileState> *>(ctx)->push_back(*s);
+        return std::int32_t{0};
+    };
+
+    SECTION("Same samples as the trajectory buffer")
+    {
+        std::vector<GrvxMissileState> samples;
+        std::int32_t premature1 = 0;
+        auto n1 = grvx_stream_missile(&state,
+                                      planets,
+                                      H,
+                                      int_steps,
+                                      trj_size,
+                                      collect,
+                                      &samples,
+                                      &premature1);
+        REQUIRE(n1 == samples.size());
+
+        int premature2 = 0;
+        auto n2 = grvx_propagate_missile(m, planets, H, &premature2);
+        REQUIRE(n1 == n2);
+        REQUIRE(premature1 == premature2);
+
+        for (unsigned j = 0; j < n1; j++) {
+            for (unsigned c = 0; c < 3; c++) {
+                REQUIRE(samples[j].x[c] == m->x[j][c]);
+                REQUIRE(samples[j].v[c] == m->v[j][c]);
+            }
+        }
+        for (unsigned c = 0; c < 3; c++) {
+            REQUIRE(state.x[c] == m->x[n1 - 1][c]);
+            REQUIRE(state.v[c] == m->v[n1 - 1][c]);
+        }
+    }
+
+    SECTION("Ring buffer keeps the most recent samples")
+    {
+        const unsigned N = 20;
+        std::vector<GrvxMissileState> samples;
+        auto state2 = state;
+        std::int32_t premature = 0;
+        auto n = grvx_stream_missile(&state2,
+                                     planets,
+                                     H,
+                                     3,
+                                     N,
+                                     collect,
+                                     &samples,
+                                     &premature);
+        REQUIRE(premature == 0);
+        REQUIRE(n == N);
+
+        std::vector<GrvxMissileState> buffer(8);
+        GrvxSampleRing ring = {buffer.data(), 8, 0, 0};
+        n = grvx_stream_missile(&state,
+                                planets,
+                                H,
+                                3,
+                                N,
+                                grvx_ring_sink,
+                                &ring,
+                                &premature);
+        REQUIRE(n == N);
+        REQUIRE(ring.count == 8);
+        REQUIRE(ring.head == N % 8);
+
+        for (unsigned k = 0; k < 8; k++) {
+            const auto &s1 = buffer[(ring.head + k) % 8];
+            const auto &s2 = samples[N - 8 + k];
+            for (unsigned c = 0; c < 3; c++) {
+                REQUIRE(s1.x[c] == s2.x[c]);
+                REQUIRE(s1.v[c] == s2.v[c]);
+            }
+        }
+    }
+
+    SECTION("Sink stops the propagation")
+    {
+        auto stop = [](void *, std::uint32_t i, const GrvxMissileState *) {
+            return std::int32_t{i == 3};
+        };
+
+        std::int32_t premature = 0;
+        auto n = grvx_stream_missile(&state,
+                                     planets,
+                                     H,
+                                     1,
+                                     100,
+                                     stop,
+                                     nullptr,
+                                     &premature);
+        REQUIRE(n == 4);
+        REQUIRE(premature == 0);
+    }
+
+    grvx_delete_missiles(trj);
+    grvx_delete_planets(planets);
+}
+
+TEST_CASE("Test packed propagation", "[missile]")
+{
+    const double H = 1e-3;
+
+    auto planets = grvx_new_planets(2);
+    REQUIRE(grvx_set_planet(planets, 0, 0., 0.) == 0);
+    REQUIRE(grvx_set_planet(planets, 1, .5, 1.) == 0);
+
+    auto trj = grvx_new_missiles(1);
+    auto *m = grvx_get_trajectory(trj, 0);
+    REQUIRE(grvx_launch_missile(m, planets, 1, .9 * grvx_v_esc(), 2.) == 0);
+
+    auto packed = std::make_unique<GrvxPackedTrajectory>();
+    REQUIRE(grvx_launch_missile_state(
+                &packed->state, planets, 1, .9 * grvx_v_esc(), 2.) == 0);
+
+    // chained calls continue from the unquantized state
+    int premature1 = 0;
+    for (int k = 0; k < 3 && premature1 == 0; k++) {
+        auto n1 = grvx_propagate_missile(m, planets, H, &premature1);
+
+        std::int32_t premature2 = 0;
+        auto n2 = grvx_propagate_missile_packed(
+            packed.get(), planets, H, &premature2);
+        REQUIRE(n1 == n2);
+        REQUIRE(premature1 == premature2);
+
+        for (unsigned j = 0; j < n1; j++) {
+            INFO("Call k=" << k << ", sample j=" << j);
+
+            GrvxMissileState s;
+            grvx_unpack_sample(&packed->samples[j], &s);
+            for (unsigned c = 0; c < 3; c++) {
+                REQUIRE(s.x[c] == Approx(m->x[j][c]).margin(5e-5));
+                REQUIRE(s.v[c] == Approx(m->v[j][c]).margin(1e-4));
+            }
+        }
+    }
+
+    grvx_delete_missiles(trj);
+    grvx_delete_planets(planets);
+}
+
+static double distance(const double *a, const double *b)
+{
+    return std::hypot(a[0] - b[0], a[1] - b[1], a[2] - b[2]);
+}
+
+TEST_CASE("Test adaptive propagation", "[missile]")
+{
+    const double H = 1e-3;
+
+    auto planets = grvx_new_planets(3);
+    REQUIRE(grvx_set_planet(planets, 0, 0., 0.) == 0);
+    REQUIRE(grvx_set_planet(planets, 1, .5, 2.) == 0);
+    REQUIRE(grvx_set_planet(planets, 2, -.7, -2.5) == 0);
+
+    auto missiles = grvx_new_missiles(5);
+    std::vector<GrvxTrajectory *> m;
+    for (unsigned i = 0; i < 5; i++) {
+        m.push_back(grvx_get_trajectory(missiles, i));
+
+        // close flyby at planet 0
+        REQUIRE(grvx_init_missile(m[i], .5, .05, 1., -1., 0.) == 0);
+    }
+
+    int premature1 = 0;
+    auto n1 = grvx_propagate_missile(m[0], planets, H, &premature1);
+    REQUIRE(n1 > 30);
+
+    // large steps far from planets but same sampling
+    int premature2 = 0;
+    auto n2 =
+        grvx_propagate_missile_adaptive(m[1], planets, H, 4. * H, &premature2);
+
+    REQUIRE(n1 == n2);
+    REQUIRE(premature1 == premature2);
+
+    // Richardson estimates of the global errors of both propagations from
+    // runs with halved step sizes, i.e., 2^p / (2^p - 1) times the deviation
+    // for a scheme of order p, plus the rounding errors of all steps. The
+    // fixed step size is halved over two calls, which are sampled twice as
+    // often.
+    auto *cfg = grvx_get_config();
+    const int p = cfg->composition_scheme[1] - '0';
+    grvx_free_config(cfg);
+    const double rounding = GRVX_TRAJECTORY_SIZE * GRVX_INT_STEPS * DBL_EPSILON;
+    const double richardson = std::ldexp(1., p) / (std::ldexp(1., p) - 1.);
+
+    int premature3 = 0;
+    grvx_propagate_missile_adaptive(m[2], planets, H, 2. * H, &premature3);
+    REQUIRE(premature3 == premature1);
+
+    int premature4 = 0;
+    auto n4 = grvx_propagate_missile(m[3], planets, H / 2., &premature4);
+    unsigned n5 = 0;
+    if (premature4 == 0) {
+        *m[4] = *m[3];
+        n5 = grvx_propagate_missile(m[4], planets, H / 2., &premature4);
+    }
+
+    // the last step ends at different times if the missile hits a planet
+    const unsigned n = premature1 ? n1 - 1 : n1;
+    const unsigned n_half = premature4 ? n4 + n5 - 1 : n4 + n5;
+    for (unsigned j = 0; j < n && 2 * j + 1 < n_half; j++) {
+        INFO("Step j=" << j);
+        const unsigned i = 2 * j + 1;
+        auto *half = i < n4 ? m[3] : m[4];
+        const unsigned k = i < n4 ? i : i - n4;
+
+        const double err_x = richardson * (distance(m[0]->x[j], half->x[k]) +
+                                           distance(m[1]->x[j], m[2]->x[j]));
+        const double err_v = richardson * (distance(m[0]->v[j], half->v[k]) +
+                                           distance(m[1]->v[j], m[2]->v[j]));
+        REQUIRE(distance(m[0]->x[j], m[1]->x[j]) <= 2. * err_x + rounding);
+        REQUIRE(distance(m[0]->v[j], m[1]->v[j]) <= 2. * err_v + rounding);
+    }
+
+    grvx_delete_missiles(missiles);
+    grvx_delete_planets(planets);
+}
+
+TEST_CASE("Test adaptive propagation of a close flyby", "[missile]")
+{
+    const double H = 5e-3;
+
+    auto planets = grvx_new_planets(1);
+    REQUIRE(grvx_set_planet(planets, 0, 0., 0.) == 0);
+
+    // close flyby, propagated with small steps throughout, adaptive steps and
+    // fixed steps, respectively
+    auto missiles = grvx_new_missiles(3);
+    auto *ref = grvx_get_trajectory(missiles, 0);
+    auto *adaptive = grvx_get_trajectory(missiles, 1);
+    auto *fixed = grvx_get_trajectory(missiles, 2);
+    for (auto *m : {ref, adaptive, fixed}) {
+        REQUIRE(grvx_init_missile(m, .5, .05, 2., -1., 0.) == 0);
+    }
+
+    int premature = 0;
+    auto n =
+        grvx_propagate_missile_adaptive(ref, planets, H, H / 8., &premature);
+    REQUIRE(premature == 0);
+
+    // twice the fixed step size far from the planet
+    GrvxStats stats;
+    grvx_reset_stats();
+    REQUIRE(grvx_propagate_missile_adaptive(
+                adaptive, planets, H, 2. * H, &premature) == n);
+    REQUIRE(premature == 0);
+    grvx_get_stats(&stats);
+    const auto n_adaptive = stats.n_force_evaluations;
+
+    grvx_reset_stats();
+    REQUIRE(grvx_propagate_missile(fixed, planets, H, &premature) == n);
+    REQUIRE(premature == 0);
+    grvx_get_stats(&stats);
+    const auto n_fixed = stats.n_force_evaluations;
+
+    double err_adaptive = 0.;
+    double err_fixed = 0.;
+    for (unsigned j = 0; j < n; j++) {
+        err_adaptive =
+            std::max(err_adaptive, distance(adaptive->x[j], ref->x[j]));
+        err_fixed = std::max(err_fixed, distance(fixed->x[j], ref->x[j]));
+    }
+
+    // the flyby dominates the error of fixed steps
+    REQUIRE(err_adaptive < err_fixed);
+#if GRVX_STATS
+    REQUIRE(n_adaptive < n_fixed);
+#else
+    REQUIRE(n_adaptive == 0);
+    REQUIRE(n_fixed == 0);
+#endif
+
+    grvx_delete_missiles(missiles);
+    grvx_delete_planets(planets);
+}
+
+TEST_CASE("Test interpolation of trajectories", "[missile]")
+{
+    const double H = 1e-3;
+    const double V = grvx_v_esc();
+
+    auto planets = grvx_new_planets(2);
+    REQUIRE(grvx_set_planet(planets, 0, 0., 0.) == 0);
+    REQUIRE(grvx_set_planet(planets, 1, .5, 2.) == 0);
+
+    auto missiles = grvx_new_missiles(2);
+    auto *coarse = grvx_get_trajectory(missiles, 0);
+    auto *fine = grvx_get_trajectory(missiles, 1);
+    REQUIRE(grvx_launch_missile(coarse, planets, 0, 1.5 * V, .3) == 0);
+    REQUIRE(grvx_launch_missile(fine, planets, 0, 1.5 * V, .3) == 0);
+
+    int premature = 0;
+    auto n1 = grvx_propagate_missile(coarse, planets, H, &premature);
+    REQUIRE(premature == 0);
+
+    // the (2k + 2)-th point of fine is halfway between the k-th and
+    // (k + 1)-th point of coarse
+    auto n2 = grvx_propagate_missile(fine, planets, H / 2., &premature);
+    REQUIRE(premature == 0);
+    REQUIRE(n1 == n2);
+
+    auto *cfg = grvx_get_config();
+    const double dt = cfg->int_steps * H;
+    grvx_free_config(cfg);
+
+    // The error at the midpoint is bounded by the cubic Hermite remainder,
+    // i.e., |x''''| dt^4 / 384 for x and sqrt(3) / 216 |x''''| dt^3 for v,
+    // plus the difference of the integrators with step sizes H and H / 2 at
+    // the nodes, carried to the midpoint by the Hermite basis. x'''' is
+    // estimated by the fourth difference of fine. Both terms are leading
+    // order only, hence the factor 2.
+    double x[3];
+    double v[3];
+    for (unsigned k = 8; 2 * k + 4 < n2; k++) {
+        INFO("Point k=" << k);
+        REQUIRE(grvx_interpolate_missile(coarse, n1, H, k + .5, x, v) == 0);
+
+        // orthogonal up to the rounding errors of the projection
+        const double v_abs = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        REQUIRE(x[0] * x[0] + x[1] * x[1] + x[2] * x[2] == Approx(1.));
+        REQUIRE(x[0] * v[0] + x[1] * v[1] + x[2] * v[2] ==
+                Approx(0.).margin(4. * DBL_EPSILON * v_abs));
+
+        double d4x = 0.;
+        double dx = 0.;
+        double dv = 0.;
+        double err_x = 0.;
+        double err_v = 0.;
+        for (unsigned c = 0; c < 3; c++) {
+            const double d4 = fine->x[2 * k][c] - 4. * fine->x[2 * k + 1][c] +
+                              6. * fine->x[2 * k + 2][c] -
+                              4. * fine->x[2 * k + 3][c] +
+                              fine->x[2 * k + 4][c];
+            const double dx0 = coarse->x[k][c] - fine->x[2 * k + 1][c];
+            const double dx1 = coarse->x[k + 1][c] - fine->x[2 * k + 3][c];
+            const double dv0 = coarse->v[k][c] - fine->v[2 * k + 1][c];
+            const double dv1 = coarse->v[k + 1][c] - fine->v[2 * k + 3][c];
+            const double tx = (dx0 + dx1) / 2. + dt / 8. * (dv0 - dv1);
+            const double tv = 1.5 * (dx1 - dx0) / dt - (dv0 + dv1) / 4.;
+            const double ex = x[c] - fine->x[2 * k + 2][c];
+            const double ev = v[c] - fine->v[2 * k + 2][c];
+
+            d4x += d4 * d4;
+            dx += tx * tx;
+            dv += tv * tv;
+            err_x += ex * ex;
+            err_v += ev * ev;
+        }
+
+        // fine is sampled every dt / 2
+        const double x4 = 16. * std::sqrt(d4x) / std::pow(dt, 4);
+        REQUIRE(std::sqrt(err_x) <=
+                2. * (std::sqrt(dx) + x4 * std::pow(dt, 4) / 384.));
+        REQUIRE(std::sqrt(err_v) <=
+                2. * (std::sqrt(dv) +
+                      std::sqrt(3.) / 216. * x4 * std::pow(dt, 3)));
+    }
+
+    // trajectory points are reproduced
+    REQUIRE(grvx_interpolate_missile(coarse, n1, H, n1 - 1., x, v) == 0);
+    for (unsigned c = 0; c < 3; c++) {
+        REQUIRE(x[c] == Approx(coarse->x[n1 - 1][c]));
+        REQUIRE(v[c] == Approx(coarse->v[n1 - 1][c]));
+    }
+
+    REQUIRE(grvx_interpolate_missile(coarse, n1, H, -.1, x, v) != 0);
+    REQUIRE(grvx_interpolate_missile(coarse, n1, H, n1 - .9, x, v) != 0);
+
+    grvx_delete_missiles(missiles);
+    grvx_delete_planets(planets);
+}
@@ -1,6 +1,9 @@
 #include "libgravix2/api.h"
 #include <catch2/catch.hpp>
 #include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
 
 TEST_CASE("Test planet", "[planet]")
 {
@@ -50,3 +53,92 @@ TEST_CASE("Test planet", "[planet]")
 
     grvx_delete_planets(planets);
 }
+
+TEST_CASE("Test bulk access of planets", "[planet]")
+{
+    auto planets = grvx_new_planets(3);
+
+    const double lat[3] = {.1, -.3, .5};
+    const double lon[3] = {.2, .4, -2.6};
+    REQUIRE(grvx_set_planets(planets, 4, lat, lon) != 0);
+    REQUIRE(grvx_set_planets(planets, 3, lat, lon) == 0);
+
+    double lat2[3], lon2[3];
+    REQUIRE(grvx_get_planets(planets, 4, lat2, lon2) != 0);
+    REQUIRE(grvx_get_planets(planets, 3, lat2, lon2) == 0);
+    for (unsigned i = 0; i < 3; i++) {
+        double lat1, lon1;
+        REQUIRE(grvx_get_planet(planets, i, &lat1, &lon1) == 0);
+        REQUIRE(lat2[i] == lat1);
+        REQUIRE(lon2[i] == lon1);
+        REQUIRE(lat2[i] == Approx(lat[i]));
+        REQUIRE(lon2[i] == Approx(lon[i]));
+    }
+
+    grvx_delete_planets(planets);
+}
+
+static int closest_planet(GrvxPlanetsHandle planets, double lat, double lon)
+{
+    int closest = -1;
+    double max_dot = -2.;
+
+    const auto n = static_cast<int>(grvx_count_planets(planets));
+    for (int i = 0; i < n; i++) {
+        double p_lat, p_lon;
+        grvx_get_planet(planets, static_cast<uint32_t>(i), &p_lat, &p_lon);
+        const double dot =
+            std::sin(lat) * std::sin(p_lat) +
+            std::cos(lat) * std::cos(p_lat) * std::cos(lon - p_lon);
+        if (dot > max_dot) {
+            max_dot = dot;
+            closest = i;
+        }
+    }
+
+    return closest;
+}
+
+TEST_CASE("Test closest planet", "[planet]")
+{
+    using std::numbers::pi;
+
+    auto n_planets = GENERATE(0U, 10U, 1000U);
+    auto planets = grvx_new_planets(n_planets);
+
+    std::mt19937 gen{42};
+    std::uniform_real_distribution<double> u{-1., 1.};
+
+    std::vector<double> lat(n_planets), lon(n_planets);
+    for (unsigned i = 0; i < n_planets; i++) {
+        lat[i] = std::asin(u(gen));
+        lon[i] = u(gen) * pi;
+    }
+    grvx_set_planets(planets, n_planets, lat.data(), lon.data());
+
+    // random positions, poles, and both sides of the date line
+    std::vector<std::pair<double, double>> queries = {
+        {pi / 2., 0.}, {-pi / 2., 0.}, {.1, pi}, {-.1, -pi}, {0., pi - 1e-12}};
+    for (int i = 0; i < 200; i++) {
+        queries.emplace_back(std::asin(u(gen)), u(gen) * pi);
+    }
+
+    for (const auto &[q_lat, q_lon] : queries) {
+        REQUIRE(grvx_closest_planet(planets, q_lat, q_lon) ==
+                closest_planet(planets, q_lat, q_lon));
+    }
+
+    if (n_planets > 0) {
+        // moved and removed planets invalidate the index
+        grvx_set_planet(planets, 0, .3, .4);
+        REQUIRE(grvx_closest_planet(planets, .3, .4) == 0);
+
+        grvx_pop_planet(planets);
+        for (const auto &[q_lat, q_lon] : queries) {
+            REQUIRE(grvx_closest_planet(planets, q_lat, q_lon) ==
+                    closest_planet(planets, q_lat, q_lon));
+        }
+    }
+
+    grvx_delete_planets(planets);
+}
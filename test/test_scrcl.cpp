@@ -1,7 +1,10 @@
 #include "libgravix2/api.h"
+#include "libgravix2/config.h"
 #include <catch2/catch.hpp>
+#include <cfloat>
 #include <cmath>
 #include <numbers>
+#include <vector>
 
 static double dist(double xyz[3])
 {
@@ -48,3 +51,138 @@ TEST_CASE("Test small circle dynamics")
     grvx_delete_missiles(trj);
     grvx_delete_planets(p);
 }
+
+TEST_CASE("Test small circle dynamics in single precision")
+{
+    const int N = 100;
+    const double H = 1e-3;
+
+    auto r = 10. / 180. * std::numbers::pi;
+    auto v = grvx_v_scrcl(r);
+
+    auto p = grvx_new_planets(1);
+    auto rc = grvx_set_planet(p, 0, 0., 0.);
+    REQUIRE(rc == 0);
+
+    auto trj = grvx_new_missiles(1);
+    auto *m = grvx_get_trajectory(trj, 0);
+    rc = grvx_init_missile(m, r, 0., v, 0., 1.);
+    REQUIRE(rc == 0);
+
+    for (int i = 0; i < N; i++) {
+        uint32_t n = 0;
+        int32_t premature = 0;
+        grvx_propagate_missiles_f32(trj, 1, p, H, &n, &premature);
+        REQUIRE(premature == 0);
+
+        for (uint32_t j = 0; j < n; j++) {
+            const double dr = dist(m->x[j]) - r;
+
+            double vx = m->v[j][0];
+            double vy = m->v[j][1];
+            double vz = m->v[j][2];
+            double dv = std::sqrt(vx * vx + vy * vy + vz * vz) - v;
+
+            // the rounding errors of all stages accumulate like a random walk
+            const double n_stages = GRVX_COMPOSITION_STAGES * GRVX_INT_STEPS *
+                                    (i * GRVX_TRAJECTORY_SIZE + j + 1.);
+            const double tol = FLT_EPSILON * std::sqrt(n_stages);
+            REQUIRE(dr == Approx(0.).margin(tol));
+            REQUIRE(dv == Approx(0.).margin(tol * v));
+        }
+    }
+
+    grvx_delete_missiles(trj);
+    grvx_delete_planets(p);
+}
+
+#if GRVX_POT_TYPE == GRVX_POT_TYPE_3D
+// number of explicitly summed terms of the reference series, the remainder of
+// the infinite series (GRVX_N_POT = 0) is approximated by an integral
+static constexpr int N_REF = GRVX_N_POT > 0 ? GRVX_N_POT : 1000;
+
+// reference series of the force, i.e., without tabulation or resummation
+static double f3D(double x)
+{
+    const double pi = std::numbers::pi;
+    const double y2 = x * x / (4. * pi * pi);
+
+    double acc = GRVX_N_POT > 0 ? 0. : .5 / (N_REF * N_REF - y2);
+    for (int j = N_REF; j-- > 0;) {
+        const double c = j + .5;
+        const double r = c * c - y2;
+        acc += c / (r * r);
+    }
+
+    const double sinc = x != 0. ? std::sin(x) / x : 1.;
+    return -acc / (8. * pi * pi * pi * pi * sinc);
+}
+
+// reference of grvx_v_scrcl() evaluated at the same (rounded) d = cos(r) as
+// the force kernel of the integrator
+static double v_scrcl(double r)
+{
+    const double d = std::cos(r);
+    return std::sin(r) *
+           std::sqrt(-f3D(std::acos(d) - std::numbers::pi) / std::fabs(d));
+}
+#endif
+
+#if GRVX_POT_TYPE == GRVX_POT_TYPE_3D && GRVX_POT_TABLE_SIZE > 0
+TEST_CASE("Test tabulated force")
+{
+    const int N = 1000;
+
+    // the relative error of the velocity is half the one of the force
+    for (int i = 0; i < N; i++) {
+        const double r = std::numbers::pi * (i + .5) / N;
+        REQUIRE(grvx_v_scrcl(r) / v_scrcl(r) - 1. ==
+                Approx(0.).margin(.5e-11));
+    }
+}
+#endif
+
+#if GRVX_POT_TYPE == GRVX_POT_TYPE_3D && GRVX_N_POT == 0
+// reference series of the potential
+static double pot3D(double x)
+{
+    const double pi = std::numbers::pi;
+    const double y = x / (2. * pi) - .5;
+    const double y2 = y * y;
+
+    double acc = -.5 * std::log1p(-y2 / (N_REF * N_REF));
+    for (int j = N_REF; j-- > 0;) {
+        const double c = j + .5;
+        acc += y2 / (c * (c * c - y2));
+    }
+
+    return acc / (4. * pi * pi);
+}
+
+TEST_CASE("Test closed-form potential")
+{
+    const double pi = std::numbers::pi;
+
+    const double v_esc = std::sqrt(2. * pot3D(GRVX_MIN_DIST));
+    REQUIRE(grvx_v_esc() / v_esc - 1. == Approx(0.).margin(1e-13));
+
+    // the resummed series converge slowest close to the planet (and its
+    // antipode), where the closed form is probed on a logarithmic scale
+    std::vector<double> rs;
+    for (int i = 0; i < 100; i++) {
+        rs.push_back(pi * (i + .5) / 100.);
+    }
+    for (int k = 1; k <= 4; k++) {
+        rs.push_back(std::pow(10., -k));
+        rs.push_back(pi - std::pow(10., -k));
+    }
+
+    // the table (if any) is interpolated from the closed form and close to
+    // the planet, both forces inherit the round-off error of acos(d) - pi
+    const double eps = GRVX_POT_TABLE_SIZE > 0 ? .5e-11 : 1e-13;
+    for (double r : rs) {
+        REQUIRE(grvx_v_scrcl(r) / v_scrcl(r) - 1. ==
+                Approx(0.).margin(eps + 1e-15 / r));
+    }
+}
+#endif
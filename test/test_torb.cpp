@@ -35,4 +35,40 @@ TEST_CASE("Test orbital time", "[integrator]")
 
     grvx_delete_missiles(missiles);
     grvx_delete_planets(p);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Test orbital time in single precision", "[integrator]")
+{
+    const double H = 1e-3;
+
+    const double V = grvx_v_esc();
+    auto [v, psi] =
+        GENERATE_COPY(std::make_pair(.5 * V, 0.),                       //
+                      std::make_pair(.99 * V, std::numbers::pi),        //
+                      std::make_pair(1.01 * V, -std::numbers::pi / 4.), //
+                      std::make_pair(2. * V, 1337.));                   //
+
+    auto p = grvx_new_planets(1);
+    int rc = grvx_set_planet(p, 0, 0., 0.);
+    REQUIRE(rc == 0);
+
+    auto missiles = grvx_new_missiles(1);
+    auto *m = grvx_get_trajectory(missiles, 0);
+    rc = grvx_launch_missile(m, p, 0, v, psi);
+    REQUIRE(rc == 0);
+
+    int32_t premature = 0;
+    unsigned n = 0;
+    while (premature == 0) {
+        uint32_t n_steps = 0;
+        grvx_propagate_missiles_f32(missiles, 1, p, H, &n_steps, &premature);
+        n += n_steps;
+    }
+
+    // rounding errors accumulate in the phase of long, weakly bound orbits
+    auto n_exp = grvx_orb_period(v, H);
+    REQUIRE(n == Approx(n_exp).margin(1.).epsilon(5e-3));
+
+    grvx_delete_missiles(missiles);
+    grvx_delete_planets(p);
+}